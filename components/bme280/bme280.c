@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "i2c_bus.h"
 #include "bme280.h"
 #include "math.h"
@@ -235,6 +236,53 @@ esp_err_t bme280_default_init(bme280_handle_t sensor)
     return ESP_OK;
 }
 
+// Oversampling register value to number of samples (0 = skipped).
+static uint32_t bme280_samples(unsigned int osrs)
+{
+    return osrs == BME280_SAMPLING_NONE ? 0 : 1u << (osrs > BME280_SAMPLING_X16 ? 4 : osrs - 1);
+}
+
+uint32_t bme280_measurement_time_us(bme280_handle_t sensor)
+{
+    // Maximum measurement time, datasheet appendix B.
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    uint32_t t = bme280_samples(sens->ctrl_meas_t.osrs_t);
+    uint32_t p = bme280_samples(sens->ctrl_meas_t.osrs_p);
+    uint32_t h = bme280_samples(sens->ctrl_hum_t.osrs_h);
+    uint32_t us = 1250 + 2300 * t;
+    if (p) {
+        us += 2300 * p + 575;
+    }
+    if (h) {
+        us += 2300 * h + 575;
+    }
+    return us;
+}
+
+void bme280_restore_settings(bme280_handle_t sensor, const bme280_data_t *calibration, bme280_sensor_mode mode, bme280_sensor_sampling tempSampling, bme280_sensor_sampling pressSampling, bme280_sensor_sampling humSampling, bme280_sensor_filter filter, bme280_standby_duration duration)
+{
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    sens->data_t = *calibration;
+    sens->ctrl_meas_t.mode = mode;
+    sens->ctrl_meas_t.osrs_t = tempSampling;
+    sens->ctrl_meas_t.osrs_p = pressSampling;
+    sens->ctrl_hum_t.osrs_h = humSampling;
+    sens->config_t.filter = filter;
+    sens->config_t.t_sb = duration;
+}
+
+const bme280_data_t *bme280_get_calibration(bme280_handle_t sensor)
+{
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    return &sens->data_t;
+}
+
+i2c_bus_device_handle_t bme280_get_i2c_device(bme280_handle_t sensor)
+{
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    return sens->i2c_dev;
+}
+
 esp_err_t bme280_take_forced_measurement(bme280_handle_t sensor)
 {
     uint8_t data = 0;
@@ -244,21 +292,85 @@ esp_err_t bme280_take_forced_measurement(bme280_handle_t sensor)
         if (i2c_bus_write_byte(sens->i2c_dev, BME280_REGISTER_CONTROL,      bme280_getctrl_meas(sensor)) != ESP_OK) {
             return ESP_FAIL;
         }
-        // wait until measurement has been completed, otherwise we would read, the values from the last measurement
-        if (i2c_bus_read_byte(sens->i2c_dev, BME280_REGISTER_STATUS, &data) != ESP_OK) {
-            return ESP_FAIL;
-        }
-        while (data & 0x08) {
-            i2c_bus_read_byte(sens->i2c_dev, BME280_REGISTER_STATUS, &data);
-            vTaskDelay(10 / portTICK_RATE_MS);
+        // sleep through the conversion instead of polling for it, rounding
+        // up to whole ticks
+        TickType_t ticks = (bme280_measurement_time_us(sensor) + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000);
+        vTaskDelay(ticks);
+        // the maximum time has passed, so this normally reads idle once
+        for (int i = 0; i < 10; i++) {
+            if (i2c_bus_read_byte(sens->i2c_dev, BME280_REGISTER_STATUS, &data) != ESP_OK) {
+                return ESP_FAIL;
+            }
+            if (!(data & 0x08)) {
+                return ESP_OK;
+            }
+            vTaskDelay(1);
         }
+        return ESP_ERR_TIMEOUT;
     }
     return ESP_OK;
 }
 
-esp_err_t bme280_read_temperature(bme280_handle_t sensor, float *temperature)
+// Temperature in 0.01 degC; also sets t_fine.
+static int32_t bme280_compensate_temperature(bme280_dev_t *sens, int32_t adc_T)
 {
     int32_t var1, var2;
+    var1 = ((((adc_T >> 3) - ((int32_t) sens->data_t.dig_t1 << 1)))
+            * ((int32_t) sens->data_t.dig_t2)) >> 11;
+
+    var2 = (((((adc_T >> 4) - ((int32_t) sens->data_t.dig_t1))
+              * ((adc_T >> 4) - ((int32_t) sens->data_t.dig_t1))) >> 12)
+            * ((int32_t) sens->data_t.dig_t3)) >> 14;
+
+    sens->t_fine = var1 + var2;
+    return (sens->t_fine * 5 + 128) >> 8;
+}
+
+// Pressure in Pa, Q24.8. Needs t_fine from the temperature of the same
+// conversion.
+static esp_err_t bme280_compensate_pressure(bme280_dev_t *sens, int32_t adc_P, uint32_t *pressure)
+{
+    int64_t var1, var2, p;
+    var1 = ((int64_t) sens->t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t) sens->data_t.dig_p6;
+    var2 = var2 + ((var1 * (int64_t) sens->data_t.dig_p5) << 17);
+    var2 = var2 + (((int64_t) sens->data_t.dig_p4) << 35);
+    var1 = ((var1 * var1 * (int64_t) sens->data_t.dig_p3) >> 8) + ((var1 * (int64_t) sens->data_t.dig_p2) << 12);
+    var1 = (((((int64_t) 1) << 47) + var1)) * ((int64_t) sens->data_t.dig_p1) >> 33;
+    if (var1 == 0) {
+        return ESP_FAIL; // avoid exception caused by division by zero
+    }
+    p = 1048576 - adc_P;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t) sens->data_t.dig_p9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t) sens->data_t.dig_p8) * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (((int64_t) sens->data_t.dig_p7) << 4);
+    *pressure = (uint32_t) p;
+    return ESP_OK;
+}
+
+// Humidity in %RH, Q22.10. Needs t_fine from the temperature of the same
+// conversion.
+static uint32_t bme280_compensate_humidity(bme280_dev_t *sens, int32_t adc_H)
+{
+    int32_t v_x1_u32r;
+    v_x1_u32r = (sens->t_fine - ((int32_t) 76800));
+    v_x1_u32r = (((((adc_H << 14) - (((int32_t) sens->data_t.dig_h4) << 20)
+                    - (((int32_t) sens->data_t.dig_h5) * v_x1_u32r))
+                   + ((int32_t) 16384)) >> 15)
+                 * (((((((v_x1_u32r * ((int32_t) sens->data_t.dig_h6)) >> 10)
+                        * (((v_x1_u32r * ((int32_t) sens->data_t.dig_h3)) >> 11)  + ((int32_t) 32768))) >> 10) + ((int32_t) 2097152))
+                     * ((int32_t) sens->data_t.dig_h2) + 8192) >> 14));
+    v_x1_u32r = (v_x1_u32r
+                 - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7)
+                     * ((int32_t) sens->data_t.dig_h1)) >> 4));
+    v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
+    v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
+    return (uint32_t)(v_x1_u32r >> 12);
+}
+
+esp_err_t bme280_read_temperature(bme280_handle_t sensor, float *temperature)
+{
     uint8_t data[3] = { 0 };
     bme280_dev_t *sens = (bme280_dev_t *) sensor;
     if (i2c_bus_read_bytes(sens->i2c_dev, BME280_REGISTER_TEMPDATA, 3, data) != ESP_OK) {
@@ -268,24 +380,14 @@ esp_err_t bme280_read_temperature(bme280_handle_t sensor, float *temperature)
     if (adc_T == 0x800000) {      // value in case temp measurement was disabled
         return ESP_FAIL;
     }
-    adc_T >>= 4;
-
-    var1 = ((((adc_T >> 3) - ((int32_t) sens->data_t.dig_t1 << 1)))
-            * ((int32_t) sens->data_t.dig_t2)) >> 11;
-
-    var2 = (((((adc_T >> 4) - ((int32_t) sens->data_t.dig_t1))
-              * ((adc_T >> 4) - ((int32_t) sens->data_t.dig_t1))) >> 12)
-            * ((int32_t) sens->data_t.dig_t3)) >> 14;
-
-    sens->t_fine = var1 + var2;
-    *temperature = ((sens->t_fine * 5 + 128) >> 8) / 100.0;
+    *temperature = bme280_compensate_temperature(sens, adc_T >> 4) / 100.0;
     return ESP_OK;
 }
 
 esp_err_t bme280_read_pressure(bme280_handle_t sensor, float *pressure)
 {
-    int64_t var1, var2, p;
     uint8_t data[3] = { 0 };
+    uint32_t p;
     bme280_dev_t *sens = (bme280_dev_t *) sensor;
     float temp = 0.0;
     if (bme280_read_temperature(sensor, &temp) != ESP_OK) {
@@ -299,23 +401,10 @@ esp_err_t bme280_read_pressure(bme280_handle_t sensor, float *pressure)
     if (adc_P == 0x800000) {  // value in case pressure measurement was disabled
         return ESP_FAIL;
     }
-    adc_P >>= 4;
-    var1 = ((int64_t) sens->t_fine) - 128000;
-    var2 = var1 * var1 * (int64_t) sens->data_t.dig_p6;
-    var2 = var2 + ((var1 * (int64_t) sens->data_t.dig_p5) << 17);
-    var2 = var2 + (((int64_t) sens->data_t.dig_p4) << 35);
-    var1 = ((var1 * var1 * (int64_t) sens->data_t.dig_p3) >> 8) + ((var1 * (int64_t) sens->data_t.dig_p2) << 12);
-    var1 = (((((int64_t) 1) << 47) + var1)) * ((int64_t) sens->data_t.dig_p1) >> 33;
-    if (var1 == 0) {
-        return ESP_FAIL; // avoid exception caused by division by zero
+    if (bme280_compensate_pressure(sens, adc_P >> 4, &p) != ESP_OK) {
+        return ESP_FAIL;
     }
-    p = 1048576 - adc_P;
-    p = (((p << 31) - var2) * 3125) / var1;
-    var1 = (((int64_t) sens->data_t.dig_p9) * (p >> 13) * (p >> 13)) >> 25;
-    var2 = (((int64_t) sens->data_t.dig_p8) * p) >> 19;
-    p = ((p + var1 + var2) >> 8) + (((int64_t) sens->data_t.dig_p7) << 4);
-    p = p >> 8; // /256
-    *pressure = (float) p / 100;
+    *pressure = (float)(p >> 8) / 100; // whole Pa to hPa
     return ESP_OK;
 }
 
@@ -335,20 +424,48 @@ esp_err_t bme280_read_humidity(bme280_handle_t sensor, float *humidity)
     if (adc_H == 0x8000) { // value in case humidity measurement was disabled
         return ESP_FAIL;
     }
-    int32_t v_x1_u32r;
-    v_x1_u32r = (sens->t_fine - ((int32_t) 76800));
-    v_x1_u32r = (((((adc_H << 14) - (((int32_t) sens->data_t.dig_h4) << 20)
-                    - (((int32_t) sens->data_t.dig_h5) * v_x1_u32r))
-                   + ((int32_t) 16384)) >> 15)
-                 * (((((((v_x1_u32r * ((int32_t) sens->data_t.dig_h6)) >> 10)
-                        * (((v_x1_u32r * ((int32_t) sens->data_t.dig_h3)) >> 11)  + ((int32_t) 32768))) >> 10) + ((int32_t) 2097152))
-                     * ((int32_t) sens->data_t.dig_h2) + 8192) >> 14));
-    v_x1_u32r = (v_x1_u32r
-                 - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7)
-                     * ((int32_t) sens->data_t.dig_h1)) >> 4));
-    v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
-    v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
-    *humidity = (v_x1_u32r >> 12) / 1024.0;
+    *humidity = bme280_compensate_humidity(sens, adc_H) / 1024.0;
+    return ESP_OK;
+}
+
+esp_err_t bme280_compensate_fixed(bme280_handle_t sensor, int32_t adc_T, int32_t adc_P, int32_t adc_H, bme280_fixed_t *out)
+{
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    out->temperature = bme280_compensate_temperature(sens, adc_T);
+    if (bme280_compensate_pressure(sens, adc_P, &out->pressure) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    out->humidity = bme280_compensate_humidity(sens, adc_H);
+    return ESP_OK;
+}
+
+esp_err_t bme280_read_all_fixed(bme280_handle_t sensor, bme280_fixed_t *out)
+{
+    // press_msb .. hum_lsb in one burst, so all three come from the same
+    // conversion (the data registers are shadowed during a burst read).
+    uint8_t data[8] = { 0 };
+    bme280_dev_t *sens = (bme280_dev_t *) sensor;
+    if (i2c_bus_read_bytes(sens->i2c_dev, BME280_REGISTER_PRESSUREDATA, 8, data) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    int32_t adc_P = (data[0] << 16) | (data[1] << 8) | data[2];
+    int32_t adc_T = (data[3] << 16) | (data[4] << 8) | data[5];
+    int32_t adc_H = (data[6] << 8) | data[7];
+    if (adc_T == 0x800000 || adc_P == 0x800000 || adc_H == 0x8000) {
+        return ESP_FAIL;
+    }
+    return bme280_compensate_fixed(sensor, adc_T >> 4, adc_P >> 4, adc_H, out);
+}
+
+esp_err_t bme280_read_all(bme280_handle_t sensor, float *temperature, float *pressure, float *humidity)
+{
+    bme280_fixed_t fixed;
+    if (bme280_read_all_fixed(sensor, &fixed) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    *temperature = fixed.temperature / 100.0;
+    *pressure = (float)(fixed.pressure >> 8) / 100;
+    *humidity = fixed.humidity / 1024.0;
     return ESP_OK;
 }
 
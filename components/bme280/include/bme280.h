@@ -192,6 +192,13 @@ typedef struct {
 
 typedef void *bme280_handle_t; /*handle of bme280*/
 
+// Compensated values in the datasheet's integer formats
+typedef struct {
+    int32_t temperature;     // 0.01 degC
+    uint32_t pressure;       // Pa, Q24.8
+    uint32_t humidity;       // %RH, Q22.10
+} bme280_fixed_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -304,18 +311,66 @@ esp_err_t bme280_set_sampling(bme280_handle_t sensor, bme280_sensor_mode mode,
  */
 esp_err_t bme280_default_init(bme280_handle_t sensor);
 
+/**
+ * @brief  Maximum conversion time for the current oversampling settings
+ *
+ * @param  sensor object handle of bme280
+ *
+ * @return
+ *    - uint32_t time in microseconds
+ */
+uint32_t bme280_measurement_time_us(bme280_handle_t sensor);
+
+/**
+ * @brief  Restore calibration and settings saved from an earlier init
+ *
+ * No I2C traffic: for a sensor that kept its registers while the host slept.
+ *
+ * @param  sensor object handle of bme280
+ * @param  calibration coefficients from bme280_get_calibration()
+ * @param  mode, samplings, filter, duration as given to bme280_set_sampling()
+ */
+void bme280_restore_settings(bme280_handle_t sensor, const bme280_data_t *calibration,
+                             bme280_sensor_mode mode,
+                             bme280_sensor_sampling tempsampling,
+                             bme280_sensor_sampling presssampling,
+                             bme280_sensor_sampling humsampling, bme280_sensor_filter filter,
+                             bme280_standby_duration duration);
+
+/**
+ * @brief  Calibration coefficients read by bme280_read_coefficients()
+ *
+ * @param  sensor object handle of bme280
+ *
+ * @return
+ *    - pointer to the coefficients held in the handle
+ */
+const bme280_data_t *bme280_get_calibration(bme280_handle_t sensor);
+
+/**
+ * @brief  I2C device the sensor was created on
+ *
+ * @param  sensor object handle of bme280
+ *
+ * @return
+ *    - i2c_bus device handle, e.g. for i2c_bus_device_get_stats()
+ */
+i2c_bus_device_handle_t bme280_get_i2c_device(bme280_handle_t sensor);
+
 /**
  * @brief  Take a new measurement (only possible in forced mode)
  * If we are in forced mode, the BME sensor goes back to sleep after each
  * measurement and we need to set it to forced mode once at this point, so
  * it will take the next measurement and then return to sleep again.
  * In normal mode simply does new measurements periodically.
+ * Sleeps for the computed conversion time, then checks the status once.
  *
  * @param  sensor object handle of bme280
  *
  * @return
  *    - ESP_OK Success
  *    - ESP_FAIL Fail
+ *    - ESP_ERR_TIMEOUT Conversion did not finish
  */
 esp_err_t bme280_take_forced_measurement(bme280_handle_t sensor);
 
@@ -346,6 +401,41 @@ esp_err_t bme280_read_pressure(bme280_handle_t sensor, float *pressure);
  */
 esp_err_t bme280_read_humidity(bme280_handle_t sensor, float *humidity);
 
+/**
+ * @brief  Reads temperature, pressure and humidity in one burst
+ *
+ * All three are compensated from the same conversion, with a single I2C
+ * transaction instead of one or two per value.
+ *
+ * @param sensor object handle of bme280
+ * @param temperature pointer to temperature value
+ * @param pressure pointer to pressure value
+ * @param humidity pointer to humidity value
+ * @return esp_err_t
+ */
+esp_err_t bme280_read_all(bme280_handle_t sensor, float *temperature, float *pressure, float *humidity);
+
+/**
+ * @brief  Integer-only compensation of raw ADC values
+ *
+ * @param sensor object handle of bme280, holding the calibration
+ * @param adc_T raw 20-bit temperature
+ * @param adc_P raw 20-bit pressure
+ * @param adc_H raw 16-bit humidity
+ * @param out compensated values
+ * @return esp_err_t
+ */
+esp_err_t bme280_compensate_fixed(bme280_handle_t sensor, int32_t adc_T, int32_t adc_P, int32_t adc_H, bme280_fixed_t *out);
+
+/**
+ * @brief  Like bme280_read_all(), but leaves the values in fixed point
+ *
+ * @param sensor object handle of bme280
+ * @param out compensated values
+ * @return esp_err_t
+ */
+esp_err_t bme280_read_all_fixed(bme280_handle_t sensor, bme280_fixed_t *out);
+
 /**
  * @brief Calculates the altitude (in meters) from the specified atmospheric
  *  pressure (in hPa), and sea-level pressure (in hPa).
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_log.h"
+#include "bme280.h"
+#include "i2c_bus.h"
+
+#define I2C_MASTER_SCL_IO           GPIO_NUM_2           /*!< gpio number for I2C master clock IO2*/
+#define I2C_MASTER_SDA_IO           GPIO_NUM_1           /*!< gpio number for I2C master data  IO1*/
+#define I2C_MASTER_NUM              I2C_NUM_0            /*!< I2C port number for master bme280 */
+#define I2C_MASTER_TX_BUF_DISABLE   0                    /*!< I2C master do not need buffer */
+#define I2C_MASTER_RX_BUF_DISABLE   0                    /*!< I2C master do not need buffer */
+#define I2C_MASTER_FREQ_HZ          100000               /*!< I2C master clock frequency */
+
+static i2c_bus_handle_t i2c_bus = NULL;
+static bme280_handle_t bme280 = NULL;
+
+void bme280_test_init()
+{
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+    };
+    i2c_bus = i2c_bus_create(I2C_MASTER_NUM, &conf);
+    bme280 = bme280_create(i2c_bus, BME280_I2C_ADDRESS_DEFAULT);
+    ESP_LOGI("BME280:", "bme280_default_init:%d", bme280_default_init(bme280));
+}
+
+void bme280_test_deinit()
+{
+    bme280_delete(&bme280);
+    i2c_bus_delete(&i2c_bus);
+}
+
+void bme280_test_getdata()
+{
+    int cnt = 10;
+    while (cnt--) {
+        float temperature = 0.0, humidity = 0.0, pressure = 0.0;
+        if (ESP_OK == bme280_read_temperature(bme280, &temperature)) {
+            ESP_LOGI("BME280", "temperature:%f ", temperature);
+        }
+        vTaskDelay(300 / portTICK_RATE_MS);
+        if (ESP_OK == bme280_read_humidity(bme280, &humidity)) {
+            ESP_LOGI("BME280", "humidity:%f ", humidity);
+        }
+        vTaskDelay(300 / portTICK_RATE_MS);
+        if (ESP_OK == bme280_read_pressure(bme280, &pressure)) {
+            ESP_LOGI("BME280", "pressure:%f\n", pressure);
+        }
+        vTaskDelay(300 / portTICK_RATE_MS);
+    }
+}
+
+TEST_CASE("Device bme280 test", "[bme280][iot][device]")
+{
+    bme280_test_init();
+    bme280_test_getdata();
+    bme280_test_deinit();
+}
+
+// Datasheet section 8.1 double-precision reference, to check the integer
+// compensation against. Returns degC, Pa and %RH.
+static void bme280_reference(const bme280_data_t *c, int32_t adc_T, int32_t adc_P, int32_t adc_H,
+                             double *t, double *p, double *h)
+{
+    double var1 = (adc_T / 16384.0 - c->dig_t1 / 1024.0) * c->dig_t2;
+    double var2 = (adc_T / 131072.0 - c->dig_t1 / 8192.0) * (adc_T / 131072.0 - c->dig_t1 / 8192.0) * c->dig_t3;
+    double t_fine = var1 + var2;
+    *t = t_fine / 5120.0;
+
+    var1 = t_fine / 2.0 - 64000.0;
+    var2 = var1 * var1 * c->dig_p6 / 32768.0;
+    var2 = var2 + var1 * c->dig_p5 * 2.0;
+    var2 = var2 / 4.0 + c->dig_p4 * 65536.0;
+    var1 = (c->dig_p3 * var1 * var1 / 524288.0 + c->dig_p2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * c->dig_p1;
+    double pa = 1048576.0 - adc_P;
+    pa = (pa - var2 / 4096.0) * 6250.0 / var1;
+    var1 = c->dig_p9 * pa * pa / 2147483648.0;
+    var2 = pa * c->dig_p8 / 32768.0;
+    *p = pa + (var1 + var2 + c->dig_p7) / 16.0;
+
+    double rh = t_fine - 76800.0;
+    rh = (adc_H - (c->dig_h4 * 64.0 + c->dig_h5 / 16384.0 * rh)) *
+         (c->dig_h2 / 65536.0 * (1.0 + c->dig_h6 / 67108864.0 * rh * (1.0 + c->dig_h3 / 67108864.0 * rh)));
+    rh = rh * (1.0 - c->dig_h1 * rh / 524288.0);
+    *h = rh < 0.0 ? 0.0 : (rh > 100.0 ? 100.0 : rh);
+}
+
+TEST_CASE("bme280 fixed-point compensation matches the float reference", "[bme280][compensation]")
+{
+    // No device needed: a handle holding typical calibration coefficients.
+    bme280_dev_t dev = { 0 };
+    dev.data_t = (bme280_data_t) {
+        .dig_t1 = 27504, .dig_t2 = 26435, .dig_t3 = -1000,
+        .dig_p1 = 36477, .dig_p2 = -10685, .dig_p3 = 3024, .dig_p4 = 2855, .dig_p5 = 140,
+        .dig_p6 = -7, .dig_p7 = 15500, .dig_p8 = -14600, .dig_p9 = 6000,
+        .dig_h1 = 75, .dig_h2 = 362, .dig_h3 = 0, .dig_h4 = 307, .dig_h5 = 56, .dig_h6 = 30,
+    };
+
+    int checked = 0;
+    for (int32_t adc_T = 300000; adc_T <= 700000; adc_T += 10000) {
+        for (int32_t adc_P = 150000; adc_P <= 650000; adc_P += 12500) {
+            for (int32_t adc_H = 0; adc_H <= 65000; adc_H += 5000) {
+                double t, p, h;
+                bme280_reference(&dev.data_t, adc_T, adc_P, adc_H, &t, &p, &h);
+                // Operating range only: -40..85 degC, 300..1100 hPa
+                if (t < -40.0 || t > 85.0 || p < 30000.0 || p > 110000.0) {
+                    continue;
+                }
+                bme280_fixed_t fixed;
+                TEST_ASSERT_EQUAL(ESP_OK, bme280_compensate_fixed(&dev, adc_T, adc_P, adc_H, &fixed));
+                TEST_ASSERT_FLOAT_WITHIN(0.02f, (float)t, fixed.temperature / 100.0f);
+                TEST_ASSERT_FLOAT_WITHIN(2.0f, (float)p, fixed.pressure / 256.0f);
+                TEST_ASSERT_FLOAT_WITHIN(0.1f, (float)h, fixed.humidity / 1024.0f);
+                checked++;
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(1000, checked);
+}
+
+void app_main(void)
+{
+    printf("BME280 TEST \n");
+    unity_run_menu();
+}
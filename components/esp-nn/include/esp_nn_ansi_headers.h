@@ -65,6 +65,62 @@ void esp_nn_mul_elementwise_s8_ansi(const int8_t *input1_data,
                                     const int32_t activation_max,
                                     const int32_t size);
 
+/**
+ * @brief       elementwise addition, float
+ *
+ * @note        inputs type: float, output: float
+ *              output is clamped to [activation_min, activation_max]
+ */
+void esp_nn_add_elementwise_f32_ansi(const float *input1_data,
+                                     const float *input2_data,
+                                     float *output,
+                                     const float activation_min,
+                                     const float activation_max,
+                                     const int32_t size);
+
+/**
+ * @brief       broadcast addition, float
+ *
+ * @note        adds `row_data` (row_len values) to each of the outer_size
+ *              rows of `input_data`. row_len == 1 is a scalar broadcast.
+ *              output is clamped to [activation_min, activation_max]
+ */
+void esp_nn_add_broadcast_f32_ansi(const float *input_data,
+                                   const float *row_data,
+                                   float *output,
+                                   const float activation_min,
+                                   const float activation_max,
+                                   const int32_t outer_size,
+                                   const int32_t row_len);
+
+/**
+ * @brief       elementwise multiplication, float
+ *
+ * @note        inputs type: float, output: float
+ *              output is clamped to [activation_min, activation_max]
+ */
+void esp_nn_mul_elementwise_f32_ansi(const float *input1_data,
+                                     const float *input2_data,
+                                     float *output,
+                                     const float activation_min,
+                                     const float activation_max,
+                                     const int32_t size);
+
+/**
+ * @brief       broadcast multiplication, float
+ *
+ * @note        multiplies each of the outer_size rows of `input_data` by
+ *              `row_data` (row_len values). row_len == 1 is a scalar
+ *              broadcast. output is clamped to [activation_min, activation_max]
+ */
+void esp_nn_mul_broadcast_f32_ansi(const float *input_data,
+                                   const float *row_data,
+                                   float *output,
+                                   const float activation_min,
+                                   const float activation_max,
+                                   const int32_t outer_size,
+                                   const int32_t row_len);
+
 
 /************************** Convolution functions *****************************/
 
@@ -220,6 +276,55 @@ void esp_nn_fully_connected_per_ch_s8_ansi(const int8_t *input_data,
                                     const int32_t activation_min,
                                     const int32_t activation_max);
 
+/**
+ * @brief       block sparse fully connected - per channel
+ *
+ * @note        inputs type: int8_t, output: int8_t
+ *              input offsets: although int32_t, they are contained in 8 bits [-128, 127]
+ *              out_mult, out_shift: int32_t* containing per-channel data
+ *
+ *              filter is stored as 1 x ESP_NN_FC_SPARSE_BLOCK_LEN blocks in CSR order.
+ *              Blocks of out channel `c` are `block_row_ptr[c]` to `block_row_ptr[c + 1] - 1`.
+ *              Block `k` starts at column `block_col_idx[k] * ESP_NN_FC_SPARSE_BLOCK_LEN`
+ *              and its weights are at `block_data + k * ESP_NN_FC_SPARSE_BLOCK_LEN`.
+ *              All-zero blocks are not stored, hence filter offset must be 0.
+ *              Last block of a row is zero padded when row_len is not a multiple
+ *              of ESP_NN_FC_SPARSE_BLOCK_LEN.
+ */
+void esp_nn_fully_connected_block_sparse_per_ch_s8_ansi(const int8_t *input_data,
+                                    const int32_t input_offset,
+                                    const uint16_t row_len,
+                                    const int8_t *block_data,
+                                    const uint16_t *block_row_ptr,
+                                    const uint16_t *block_col_idx,
+                                    const int32_t *bias,
+                                    int8_t *out_data,
+                                    const uint16_t out_channels,
+                                    const int32_t out_offset,
+                                    const int32_t* out_shift,
+                                    const int32_t* out_mult,
+                                    const int32_t activation_min,
+                                    const int32_t activation_max);
+
+/**
+ * @brief       encode dense fully connected filter into block sparse format
+ *
+ * @note        filter_data: dense int8_t filter of [out_channels x row_len]
+ *              block_row_ptr needs out_channels + 1 elements.
+ *              Pass block_data and block_col_idx as NULL to only count blocks,
+ *              otherwise they need space for the returned number of blocks.
+ *
+ * @return      number of non-zero blocks, or -1 if the block count or a
+ *              column index does not fit in uint16_t. The outputs are then
+ *              only partly written.
+ */
+int32_t esp_nn_fully_connected_block_sparse_encode_s8(const int8_t *filter_data,
+                                    const uint16_t row_len,
+                                    const uint16_t out_channels,
+                                    int8_t *block_data,
+                                    uint16_t *block_row_ptr,
+                                    uint16_t *block_col_idx);
+
 /**
  * @brief   Get scratch buffer size needed by softmax function
  *
@@ -16,6 +16,14 @@
 
 #include <stdint.h>
 
+/**
+ * @brief length of one block in block sparse fully connected filters
+ *
+ * @note blocks run along the input (row) dimension: 16 int8 weights fill one
+ *       128-bit q register on esp32s3
+ */
+#define ESP_NN_FC_SPARSE_BLOCK_LEN  16
+
 /**
  * @brief structure to club data dims
  * this structure can be used for input, output and filter
@@ -232,6 +232,10 @@ void esp_nn_relu6_s8_esp32s3(int8_t *data, uint16_t size);
 
 #define esp_nn_add_elementwise_s8 esp_nn_add_elementwise_s8_esp32s3
 #define esp_nn_mul_elementwise_s8 esp_nn_mul_elementwise_s8_esp32s3
+#define esp_nn_add_elementwise_f32 esp_nn_add_elementwise_f32_ansi
+#define esp_nn_add_broadcast_f32 esp_nn_add_broadcast_f32_ansi
+#define esp_nn_mul_elementwise_f32 esp_nn_mul_elementwise_f32_ansi
+#define esp_nn_mul_broadcast_f32 esp_nn_mul_broadcast_f32_ansi
 
 #define esp_nn_depthwise_conv_s8 esp_nn_depthwise_conv_s8_esp32s3
 
@@ -250,6 +254,7 @@ void esp_nn_relu6_s8_esp32s3(int8_t *data, uint16_t size);
 
 #define esp_nn_fully_connected_s8 esp_nn_fully_connected_s8_esp32s3
 #define esp_nn_fully_connected_per_ch_s8 esp_nn_fully_connected_per_ch_s8_esp32s3
+#define esp_nn_fully_connected_block_sparse_per_ch_s8 esp_nn_fully_connected_block_sparse_per_ch_s8_ansi
 
 #define esp_nn_get_softmax_scratch_size esp_nn_get_softmax_scratch_size_opt
 #define esp_nn_set_softmax_scratch_buf esp_nn_set_softmax_scratch_buf_opt
@@ -95,3 +95,71 @@ void esp_nn_add_elementwise_s8_ansi(const int8_t *input1_data,
         output[i] = (int8_t) out;
     }
 }
+
+static inline float esp_nn_clamp_f32(float val, float min_val, float max_val)
+{
+    val = val < min_val ? min_val : val;
+    return val > max_val ? max_val : val;
+}
+
+void esp_nn_add_elementwise_f32_ansi(const float *input1_data,
+                                     const float *input2_data,
+                                     float *output,
+                                     const float activation_min,
+                                     const float activation_max,
+                                     const int32_t size)
+{
+    int i = 0;
+    for (; i < size - 3; i += 4) {
+        float out0 = input1_data[i + 0] + input2_data[i + 0];
+        float out1 = input1_data[i + 1] + input2_data[i + 1];
+        float out2 = input1_data[i + 2] + input2_data[i + 2];
+        float out3 = input1_data[i + 3] + input2_data[i + 3];
+        output[i + 0] = esp_nn_clamp_f32(out0, activation_min, activation_max);
+        output[i + 1] = esp_nn_clamp_f32(out1, activation_min, activation_max);
+        output[i + 2] = esp_nn_clamp_f32(out2, activation_min, activation_max);
+        output[i + 3] = esp_nn_clamp_f32(out3, activation_min, activation_max);
+    }
+    for (; i < size; i++) {
+        float out = input1_data[i] + input2_data[i];
+        output[i] = esp_nn_clamp_f32(out, activation_min, activation_max);
+    }
+}
+
+void esp_nn_add_broadcast_f32_ansi(const float *input_data,
+                                   const float *row_data,
+                                   float *output,
+                                   const float activation_min,
+                                   const float activation_max,
+                                   const int32_t outer_size,
+                                   const int32_t row_len)
+{
+    if (row_len == 1) {
+        /* scalar broadcast: keep the scalar in a register */
+        const float scalar = row_data[0];
+        const int32_t size = outer_size;
+        int i = 0;
+        for (; i < size - 3; i += 4) {
+            float out0 = input_data[i + 0] + scalar;
+            float out1 = input_data[i + 1] + scalar;
+            float out2 = input_data[i + 2] + scalar;
+            float out3 = input_data[i + 3] + scalar;
+            output[i + 0] = esp_nn_clamp_f32(out0, activation_min, activation_max);
+            output[i + 1] = esp_nn_clamp_f32(out1, activation_min, activation_max);
+            output[i + 2] = esp_nn_clamp_f32(out2, activation_min, activation_max);
+            output[i + 3] = esp_nn_clamp_f32(out3, activation_min, activation_max);
+        }
+        for (; i < size; i++) {
+            output[i] = esp_nn_clamp_f32(input_data[i] + scalar,
+                                         activation_min, activation_max);
+        }
+        return;
+    }
+
+    for (int outer = 0; outer < outer_size; outer++) {
+        esp_nn_add_elementwise_f32_ansi(input_data, row_data, output,
+                                        activation_min, activation_max, row_len);
+        input_data += row_len;
+        output += row_len;
+    }
+}
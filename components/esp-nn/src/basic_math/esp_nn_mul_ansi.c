@@ -0,0 +1,110 @@
+// Copyright 2020-2021 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <common_functions.h>
+
+void esp_nn_mul_elementwise_s8_ansi(const int8_t *input1_data,
+                                    const int8_t *input2_data,
+                                    const int32_t input1_offset,
+                                    const int32_t input2_offset,
+                                    int8_t *output,
+                                    const int32_t out_offset,
+                                    const int32_t out_mult,
+                                    const int32_t out_shift,
+                                    const int32_t activation_min,
+                                    const int32_t activation_max,
+                                    const int32_t size)
+{
+    for (int i = 0; i < size; i++) {
+        int32_t tmp1 = input1_data[i] + input1_offset;
+        int32_t tmp2 = input2_data[i] + input2_offset;
+
+        int32_t out = tmp1 * tmp2;
+        out = esp_nn_multiply_by_quantized_mult(out, out_mult, out_shift);
+        out = out + out_offset;
+
+        out = max(activation_min, min(out, activation_max));
+        output[i] = (int8_t) out;
+    }
+}
+
+static inline float esp_nn_clamp_f32(float val, float min_val, float max_val)
+{
+    val = val < min_val ? min_val : val;
+    return val > max_val ? max_val : val;
+}
+
+void esp_nn_mul_elementwise_f32_ansi(const float *input1_data,
+                                     const float *input2_data,
+                                     float *output,
+                                     const float activation_min,
+                                     const float activation_max,
+                                     const int32_t size)
+{
+    int i = 0;
+    for (; i < size - 3; i += 4) {
+        float out0 = input1_data[i + 0] * input2_data[i + 0];
+        float out1 = input1_data[i + 1] * input2_data[i + 1];
+        float out2 = input1_data[i + 2] * input2_data[i + 2];
+        float out3 = input1_data[i + 3] * input2_data[i + 3];
+        output[i + 0] = esp_nn_clamp_f32(out0, activation_min, activation_max);
+        output[i + 1] = esp_nn_clamp_f32(out1, activation_min, activation_max);
+        output[i + 2] = esp_nn_clamp_f32(out2, activation_min, activation_max);
+        output[i + 3] = esp_nn_clamp_f32(out3, activation_min, activation_max);
+    }
+    for (; i < size; i++) {
+        float out = input1_data[i] * input2_data[i];
+        output[i] = esp_nn_clamp_f32(out, activation_min, activation_max);
+    }
+}
+
+void esp_nn_mul_broadcast_f32_ansi(const float *input_data,
+                                   const float *row_data,
+                                   float *output,
+                                   const float activation_min,
+                                   const float activation_max,
+                                   const int32_t outer_size,
+                                   const int32_t row_len)
+{
+    if (row_len == 1) {
+        /* scalar broadcast: keep the scalar in a register */
+        const float scalar = row_data[0];
+        const int32_t size = outer_size;
+        int i = 0;
+        for (; i < size - 3; i += 4) {
+            float out0 = input_data[i + 0] * scalar;
+            float out1 = input_data[i + 1] * scalar;
+            float out2 = input_data[i + 2] * scalar;
+            float out3 = input_data[i + 3] * scalar;
+            output[i + 0] = esp_nn_clamp_f32(out0, activation_min, activation_max);
+            output[i + 1] = esp_nn_clamp_f32(out1, activation_min, activation_max);
+            output[i + 2] = esp_nn_clamp_f32(out2, activation_min, activation_max);
+            output[i + 3] = esp_nn_clamp_f32(out3, activation_min, activation_max);
+        }
+        for (; i < size; i++) {
+            output[i] = esp_nn_clamp_f32(input_data[i] * scalar,
+                                         activation_min, activation_max);
+        }
+        return;
+    }
+
+    for (int outer = 0; outer < outer_size; outer++) {
+        esp_nn_mul_elementwise_f32_ansi(input_data, row_data, output,
+                                        activation_min, activation_max, row_len);
+        input_data += row_len;
+        output += row_len;
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright 2020-2021 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <esp_nn_defs.h>
+#include <common_functions.h>
+
+void esp_nn_fully_connected_block_sparse_per_ch_s8_ansi(const int8_t *input_data,
+                                    const int32_t input_offset,
+                                    const uint16_t row_len,
+                                    const int8_t *block_data,
+                                    const uint16_t *block_row_ptr,
+                                    const uint16_t *block_col_idx,
+                                    const int32_t *bias,
+                                    int8_t *out_data,
+                                    const uint16_t out_channels,
+                                    const int32_t out_offset,
+                                    const int32_t* out_shift,
+                                    const int32_t* out_mult,
+                                    const int32_t activation_min,
+                                    const int32_t activation_max)
+{
+    for (int32_t out_c = 0; out_c < out_channels; ++out_c) {
+        int32_t result = 0;
+        for (int32_t blk = block_row_ptr[out_c]; blk < block_row_ptr[out_c + 1]; blk++) {
+            const int32_t col = block_col_idx[blk] * ESP_NN_FC_SPARSE_BLOCK_LEN;
+            const int8_t *filter = block_data + blk * ESP_NN_FC_SPARSE_BLOCK_LEN;
+            const int8_t *input = input_data + col;
+            const int32_t len = min(row_len - col, ESP_NN_FC_SPARSE_BLOCK_LEN);
+
+            if (len == ESP_NN_FC_SPARSE_BLOCK_LEN) {
+                /* full block: fixed trip count, unrolled by the compiler */
+                for (int32_t i = 0; i < ESP_NN_FC_SPARSE_BLOCK_LEN; i++) {
+                    result += filter[i] * (input[i] + input_offset);
+                }
+            } else {
+                for (int32_t i = 0; i < len; i++) {
+                    result += filter[i] * (input[i] + input_offset);
+                }
+            }
+        }
+        if (bias) {
+            result += bias[out_c];
+        }
+        result = esp_nn_multiply_by_quantized_mult(result, out_mult[out_c], out_shift[out_c]);
+        result += out_offset;
+        result = max(result, activation_min);
+        result = min(result, activation_max);
+        out_data[out_c] = (int8_t) result;
+    }
+}
+
+int32_t esp_nn_fully_connected_block_sparse_encode_s8(const int8_t *filter_data,
+                                    const uint16_t row_len,
+                                    const uint16_t out_channels,
+                                    int8_t *block_data,
+                                    uint16_t *block_row_ptr,
+                                    uint16_t *block_col_idx)
+{
+    const int32_t blocks_per_row = (row_len + ESP_NN_FC_SPARSE_BLOCK_LEN - 1) / ESP_NN_FC_SPARSE_BLOCK_LEN;
+    int32_t num_blocks = 0;
+
+    for (int32_t out_c = 0; out_c < out_channels; ++out_c) {
+        if (block_row_ptr) {
+            block_row_ptr[out_c] = (uint16_t) num_blocks;
+        }
+        const int8_t *row = filter_data + out_c * row_len;
+        for (int32_t blk_col = 0; blk_col < blocks_per_row; blk_col++) {
+            const int32_t col = blk_col * ESP_NN_FC_SPARSE_BLOCK_LEN;
+            const int32_t len = min(row_len - col, ESP_NN_FC_SPARSE_BLOCK_LEN);
+            int32_t non_zero = 0;
+            for (int32_t i = 0; i < len; i++) {
+                non_zero |= row[col + i];
+            }
+            if (non_zero == 0) {
+                continue;
+            }
+            /* row pointers and column indices are uint16_t */
+            if (num_blocks >= UINT16_MAX || blk_col > UINT16_MAX) {
+                return -1;
+            }
+            if (block_data && block_col_idx) {
+                int8_t *dst = block_data + num_blocks * ESP_NN_FC_SPARSE_BLOCK_LEN;
+                for (int32_t i = 0; i < ESP_NN_FC_SPARSE_BLOCK_LEN; i++) {
+                    dst[i] = i < len ? row[col + i] : 0;
+                }
+                block_col_idx[num_blocks] = (uint16_t) blk_col;
+            }
+            num_blocks++;
+        }
+    }
+    if (block_row_ptr) {
+        block_row_ptr[out_channels] = (uint16_t) num_blocks;
+    }
+    return num_blocks;
+}
@@ -72,10 +72,19 @@ void app_main()
     printf("max_pool, c %"PRIu32" opt %"PRIu32"\n", total_c, total_opt);
     esp_nn_fully_connected_s8_test();
     esp_nn_fully_connected_per_ch_s8_test();
+    esp_nn_fully_connected_block_sparse_per_ch_s8_test();
     esp_nn_softmax_s8_test();
     printf("softmax, c %"PRIu32" opt %"PRIu32"\n", total_c, total_opt);
     ESP_LOGI(TAG, "s8 tests done!\n");
 
+    /* f32 tests */
+    ESP_LOGI(TAG, "Running f32 tests...");
+    esp_nn_add_elementwise_f32_test();
+    printf("add f32, c %"PRIu32" opt %"PRIu32"\n", total_c, total_opt);
+    esp_nn_mul_elementwise_f32_test();
+    printf("mul f32, c %"PRIu32" opt %"PRIu32"\n", total_c, total_opt);
+    ESP_LOGI(TAG, "f32 tests done!\n");
+
     /* u8 tests */
     //ESP_LOGI(TAG, "Running u8 tests...");
     //esp_nn_add_elementwise_u8_test();
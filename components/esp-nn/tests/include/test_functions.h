@@ -25,11 +25,16 @@ void esp_nn_max_pool_s8_test();
 
 void esp_nn_fully_connected_s8_test();
 void esp_nn_fully_connected_per_ch_s8_test();
+void esp_nn_fully_connected_block_sparse_per_ch_s8_test();
 
 void esp_nn_relu6_s8_test();
 
 void esp_nn_softmax_s8_test();
 
+/* float ops tests */
+void esp_nn_add_elementwise_f32_test();
+void esp_nn_mul_elementwise_f32_test();
+
 /* uint8_t ops tests */
 void esp_nn_add_elementwise_u8_test();
 
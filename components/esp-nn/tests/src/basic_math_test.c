@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <inttypes.h>
+#include <float.h>
 
 #include <common_functions.h>
 #include <esp_nn.h>
@@ -377,3 +378,141 @@ elementwise_mult_test_cleanup:
         }
     }
 }
+
+/* reference for the float kernels: plain broadcast index math, clamp last */
+static void elementwise_f32_ref(bool is_mul, const float *input, const float *other,
+                                float *output, float act_min, float act_max,
+                                int outer_size, int row_len)
+{
+    for (int o = 0; o < outer_size; o++) {
+        for (int j = 0; j < row_len; j++) {
+            float in = input[o * row_len + j];
+            float val = is_mul ? in * other[j] : in + other[j];
+            val = val < act_min ? act_min : val;
+            output[o * row_len + j] = val > act_max ? act_max : val;
+        }
+    }
+}
+
+static void elementwise_f32_test(bool is_mul, const char *test_name)
+{
+    int size = 24 * 32 + 3; /* odd len to test leftover */
+    float *input1 = NULL;
+    float *input2 = NULL;
+    float *out_data_c = NULL;
+    float *out_data_opt = NULL;
+
+    input1 = (float *) ESP_NN_TEST_ALLOC(size * sizeof(float));
+    input2 = (float *) ESP_NN_TEST_ALLOC(size * sizeof(float));
+    out_data_c = (float *) ESP_NN_TEST_ALLOC(size * sizeof(float));
+    out_data_opt = (float *) ESP_NN_TEST_ALLOC(size * sizeof(float));
+
+    if (input1 == NULL || input2 == NULL ||
+            out_data_c == NULL || out_data_opt == NULL) {
+        printf(ANSI_COLOR_RED"%s error allocating buffers\n"ANSI_COLOR_RESET, test_name);
+        goto elementwise_f32_test_cleanup;
+    }
+
+    for (int itr = 0; itr < 9; itr++) {
+        /* itr % 3: same shape, scalar broadcast, row broadcast */
+        int outer_size, row_len;
+        switch (itr % 3) {
+        case 0:
+            outer_size = 1;
+            row_len = size;
+        break;
+        case 1:
+            outer_size = size;
+            row_len = 1;
+        break;
+        default:
+            row_len = 32 + itr;
+            outer_size = size / row_len;
+        }
+
+        /* itr / 3: no activation, relu, relu6 */
+        float act_min = -FLT_MAX;
+        float act_max = FLT_MAX;
+        if (itr / 3 >= 1) {
+            act_min = 0.f;
+        }
+        if (itr / 3 == 2) {
+            act_max = 6.f;
+        }
+
+        for (int i = 0; i < size; ++i) {
+            input1[i] = (float) (rand() % 2001 - 1000) / 100.f;
+            input2[i] = (float) (rand() % 2001 - 1000) / 100.f;
+        }
+        int count = outer_size * row_len;
+
+        if (itr == 0) {
+            /* enable profiler */
+            profile_c_start();
+        }
+        /* C function */
+        elementwise_f32_ref(is_mul, input1, input2, out_data_c, act_min, act_max,
+                            outer_size, row_len);
+
+        if (itr == 0) {
+            profile_c_end();
+            profile_opt_start();
+        }
+        /* Optimized function */
+        if (outer_size == 1) {
+            if (is_mul) {
+                esp_nn_mul_elementwise_f32(input1, input2, out_data_opt,
+                                           act_min, act_max, count);
+            } else {
+                esp_nn_add_elementwise_f32(input1, input2, out_data_opt,
+                                           act_min, act_max, count);
+            }
+        } else {
+            if (is_mul) {
+                esp_nn_mul_broadcast_f32(input1, input2, out_data_opt,
+                                         act_min, act_max, outer_size, row_len);
+            } else {
+                esp_nn_add_broadcast_f32(input1, input2, out_data_opt,
+                                         act_min, act_max, outer_size, row_len);
+            }
+        }
+
+        if (itr == 0) {
+            /* disable profiler */
+            profile_opt_end();
+        }
+
+        bool ret = CHECK_EQUAL(out_data_c, out_data_opt, count);
+        if (ret == false) {
+            printf(ANSI_COLOR_RED"%s[%d] failed\n"ANSI_COLOR_RESET, test_name, itr);
+            printf("outer_size %d, row_len %d, act [%f, %f]\n",
+                   outer_size, row_len, act_min, act_max);
+            goto elementwise_f32_test_cleanup;
+        }
+        printf(ANSI_COLOR_GREEN"%s[%d] passed\n"ANSI_COLOR_RESET, test_name, itr);
+    }
+
+elementwise_f32_test_cleanup:
+    if (input1) {
+        free(input1);
+    }
+    if (input2) {
+        free(input2);
+    }
+    if (out_data_c) {
+        free(out_data_c);
+    }
+    if (out_data_opt) {
+        free(out_data_opt);
+    }
+}
+
+void esp_nn_add_elementwise_f32_test()
+{
+    elementwise_f32_test(false, __FUNCTION__);
+}
+
+void esp_nn_mul_elementwise_f32_test()
+{
+    elementwise_f32_test(true, __FUNCTION__);
+}
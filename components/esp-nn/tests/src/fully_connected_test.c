@@ -274,3 +274,116 @@ void esp_nn_fully_connected_per_ch_s8_test()
         }
     }
 }
+
+void esp_nn_fully_connected_block_sparse_per_ch_s8_test()
+{
+    uint32_t total_dense = 0, total_sparse = 0;
+    /* layer shapes of the forecast model: {row_len, out_channels} */
+    const uint16_t shapes[][2] = {{3, 64}, {16, 64}, {16, 128}, {32, 64}, {32, 128}, {32, 192}, {96, 96}};
+    const int32_t sparsity_pct[] = {50, 75, 90};
+    const int32_t num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+    const int32_t num_sparsity = sizeof(sparsity_pct) / sizeof(sparsity_pct[0]);
+    const int32_t max_row_len = 96, max_out_ch = 192, max_filter_size = 96 * 192;
+    int8_t input[max_row_len];
+    int8_t output_c[max_out_ch], output_opt[max_out_ch];
+    int32_t activation_min = -128;
+    int32_t activation_max = 127;
+    int32_t input_offset = 3;
+    int32_t out_offset = 7;
+
+    int8_t *filter_data = ESP_NN_TEST_ALLOC(max_filter_size);
+    int8_t *block_data = ESP_NN_TEST_ALLOC(max_filter_size);
+    uint16_t *block_row_ptr = ESP_NN_TEST_ALLOC((max_out_ch + 1) * sizeof(uint16_t));
+    uint16_t *block_col_idx = ESP_NN_TEST_ALLOC(max_filter_size / ESP_NN_FC_SPARSE_BLOCK_LEN * sizeof(uint16_t));
+    int32_t *out_mult = ESP_NN_TEST_ALLOC(max_out_ch * sizeof(int32_t));
+    int32_t *out_shift = ESP_NN_TEST_ALLOC(max_out_ch * sizeof(int32_t));
+
+    printf("\n######## Running %s ##########\n", __FUNCTION__);
+    if (filter_data == NULL || block_data == NULL || block_row_ptr == NULL ||
+            block_col_idx == NULL || out_mult == NULL || out_shift == NULL) {
+        printf(ANSI_COLOR_RED"block sparse allocations failed\n"ANSI_COLOR_RESET);
+        goto fully_connected_block_sparse_cleanup;
+    }
+
+    for (int itr = 0; itr < num_shapes * num_sparsity; itr++) {
+        const uint16_t row_len = shapes[itr / num_sparsity][0];
+        const uint16_t out_channels = shapes[itr / num_sparsity][1];
+        const int32_t sparsity = sparsity_pct[itr % num_sparsity];
+        const int32_t blocks_per_row = (row_len + ESP_NN_FC_SPARSE_BLOCK_LEN - 1) / ESP_NN_FC_SPARSE_BLOCK_LEN;
+        const int32_t total_blocks = blocks_per_row * out_channels;
+
+        for (int i = 0; i < out_channels; i++) {
+            out_mult[i] = INT32_MAX / row_len + rand() % INT16_MAX;
+            out_shift[i] = -10 + rand() % 5;
+        }
+        for (int i = 0; i < row_len; ++i) {
+            input[i] = rand() % 256 - 128;
+        }
+        for (int i = 0; i < row_len * out_channels; ++i) {
+            filter_data[i] = rand() % 255 - 127;
+            if (filter_data[i] == 0) {
+                filter_data[i] = 1;
+            }
+        }
+        /* prune exactly `sparsity` percent of the blocks */
+        int32_t to_prune = total_blocks * sparsity / 100;
+        while (to_prune > 0) {
+            int32_t blk = rand() % total_blocks;
+            int32_t col = (blk % blocks_per_row) * ESP_NN_FC_SPARSE_BLOCK_LEN;
+            int8_t *row = filter_data + (blk / blocks_per_row) * row_len;
+            if (row[col] != 0) {
+                for (int i = col; i < row_len && i < col + ESP_NN_FC_SPARSE_BLOCK_LEN; i++) {
+                    row[i] = 0;
+                }
+                to_prune--;
+            }
+        }
+
+        int32_t num_blocks = esp_nn_fully_connected_block_sparse_encode_s8(filter_data, row_len, out_channels,
+                                                                            block_data, block_row_ptr, block_col_idx);
+        if (num_blocks < 0) {
+            printf(ANSI_COLOR_RED"[%3d] encode failed\n"ANSI_COLOR_RESET, itr);
+            goto fully_connected_block_sparse_cleanup;
+        }
+        uint32_t dense_bytes = row_len * out_channels;
+        uint32_t sparse_bytes = num_blocks * (ESP_NN_FC_SPARSE_BLOCK_LEN + sizeof(uint16_t)) +
+                                (out_channels + 1) * sizeof(uint16_t);
+
+        /* reference: dense C function */
+        esp_nn_fully_connected_per_ch_s8_ansi(input, input_offset, row_len, filter_data, 0,
+                                    NULL, output_c, out_channels, out_offset, out_shift, out_mult,
+                                    activation_min, activation_max);
+
+        /* dense optimized function */
+        profile_c_start();
+        esp_nn_fully_connected_per_ch_s8(input, input_offset, row_len, filter_data, 0,
+                                    NULL, output_opt, out_channels, out_offset, out_shift, out_mult,
+                                    activation_min, activation_max);
+        total_dense = profile_c_end();
+
+        /* block sparse function */
+        profile_opt_start();
+        esp_nn_fully_connected_block_sparse_per_ch_s8(input, input_offset, row_len, block_data,
+                                    block_row_ptr, block_col_idx, NULL, output_opt, out_channels,
+                                    out_offset, out_shift, out_mult, activation_min, activation_max);
+        total_sparse = profile_opt_end();
+
+        bool ret = CHECK_EQUAL(output_c, output_opt, out_channels);
+        if (ret == false) {
+            printf(ANSI_COLOR_RED"[%3d] failed\n"ANSI_COLOR_RESET, itr);
+            goto fully_connected_block_sparse_cleanup;
+        }
+        printf(ANSI_COLOR_GREEN"[%3d] passed [row_len %3"PRIu16", out_ch %3"PRIu16", sparsity %2"PRId32"%%]"ANSI_COLOR_RESET,
+               itr, row_len, out_channels, sparsity);
+        printf("\tbytes: dense %5"PRIu32", sparse %5"PRIu32"\tcycles: dense %8"PRIu32", sparse %8"PRIu32"\n",
+               dense_bytes, sparse_bytes, total_dense, total_sparse);
+    }
+
+fully_connected_block_sparse_cleanup:
+    free(filter_data);
+    free(block_data);
+    free(block_row_ptr);
+    free(block_col_idx);
+    free(out_mult);
+    free(out_shift);
+}
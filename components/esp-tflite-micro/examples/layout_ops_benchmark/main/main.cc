@@ -0,0 +1,253 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the esp_nn layout-op copy plans against the element loops of the
+// generic Split/Pack/Unpack kernels and reference_ops::Transpose /
+// reference_ops::StridedSlice. Split/Pack/Unpack use the shapes of the
+// weather model graph (unrolled LSTM over a [1, 24, 3] window); the graph has
+// no Transpose or StridedSlice, so those use window-sized shapes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "tensorflow/lite/kernels/internal/reference/strided_slice.h"
+#include "tensorflow/lite/kernels/internal/reference/transpose.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+
+namespace {
+
+using tflite::esp_nn_layout::BuildRunCopyPlan;
+using tflite::esp_nn_layout::RunCopyPlan;
+
+constexpr int kIterations = 1000;
+constexpr int kMaxBytes = 4096;
+
+int8_t src[kMaxBytes];
+int8_t ref_out[kMaxBytes];
+int8_t opt_out[kMaxBytes];
+
+// Storage laid out like a TfLiteIntArray: size followed by the dims.
+struct Dims {
+  int size;
+  int data[5];
+  const TfLiteIntArray* array() const {
+    return reinterpret_cast<const TfLiteIntArray*>(this);
+  }
+  tflite::RuntimeShape shape() const { return tflite::RuntimeShape(size, data); }
+  int flat_size() const {
+    int n = 1;
+    for (int i = 0; i < size; ++i) n *= data[i];
+    return n;
+  }
+};
+
+void Report(const char* name, int64_t ref_us, int64_t opt_us, int bytes) {
+  const bool match = memcmp(ref_out, opt_out, bytes) == 0;
+  printf("%-32s ref %6lld us  opt %6lld us  x%5.2f  %s\n", name,
+         static_cast<long long>(ref_us), static_cast<long long>(opt_us),
+         opt_us > 0 ? static_cast<float>(ref_us) / opt_us : 0.f,
+         match ? "OK" : "MISMATCH");
+}
+
+void SplitSizes(const Dims& dims, int axis, int parts, int* outer,
+                int* copy) {
+  *outer = 1;
+  for (int i = 0; i < axis; ++i) *outer *= dims.data[i];
+  *copy = dims.data[axis] / parts;
+  for (int i = axis + 1; i < dims.size; ++i) *copy *= dims.data[i];
+}
+
+// Split and Unpack: `parts` outputs cut along `axis` of `dims`. Outputs are
+// written back to back so one memcmp covers all of them.
+void BenchmarkSplit(const char* name, const Dims& dims, int axis, int parts) {
+  int outer, copy;
+  SplitSizes(dims, axis, parts, &outer, &copy);
+  const int part_size = outer * copy;
+
+  int64_t start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    const int8_t* input_ptr = src;
+    for (int k = 0; k < outer; ++k) {
+      for (int i = 0; i < parts; ++i) {
+        int8_t* output_ptr = ref_out + i * part_size + k * copy;
+        for (int j = 0; j < copy; ++j) output_ptr[j] = input_ptr[j];
+        input_ptr += copy;
+      }
+    }
+  }
+  const int64_t ref_us = esp_timer_get_time() - start;
+
+  const RunCopyPlan plan = BuildRunCopyPlan(dims.array(), axis, parts, 1);
+  start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    for (int i = 0; i < parts; ++i) {
+      tflite::esp_nn_layout::CopyPartFromStrided(
+          plan, reinterpret_cast<const uint8_t*>(src), i, parts,
+          reinterpret_cast<uint8_t*>(opt_out + i * part_size));
+    }
+  }
+  Report(name, ref_us, esp_timer_get_time() - start, dims.flat_size());
+}
+
+// Pack: `parts` inputs, read back to back from `src`, stacked along `axis` of
+// the output `dims`.
+void BenchmarkPack(const char* name, const Dims& dims, int axis, int parts) {
+  int outer, copy;
+  SplitSizes(dims, axis, parts, &outer, &copy);
+  const int part_size = outer * copy;
+
+  int64_t start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    for (int i = 0; i < parts; ++i) {
+      const int8_t* input_data = src + i * part_size;
+      for (int k = 0; k < outer; ++k) {
+        const int8_t* input_ptr = input_data + copy * k;
+        int8_t* output_ptr = ref_out + k * parts * copy + i * copy;
+        for (int j = 0; j < copy; ++j) output_ptr[j] = input_ptr[j];
+      }
+    }
+  }
+  const int64_t ref_us = esp_timer_get_time() - start;
+
+  const RunCopyPlan plan = BuildRunCopyPlan(dims.array(), axis, parts, 1);
+  start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    for (int i = 0; i < parts; ++i) {
+      tflite::esp_nn_layout::CopyPartToStrided(
+          plan, reinterpret_cast<const uint8_t*>(src + i * part_size), i,
+          parts, reinterpret_cast<uint8_t*>(opt_out));
+    }
+  }
+  Report(name, ref_us, esp_timer_get_time() - start, dims.flat_size());
+}
+
+void BenchmarkTranspose(const char* name, const Dims& dims,
+                        const int* perm) {
+  tflite::TransposeParams params;
+  params.perm_count = dims.size;
+  Dims out_dims = {dims.size, {}};
+  for (int i = 0; i < dims.size; ++i) {
+    params.perm[i] = perm[i];
+    out_dims.data[i] = dims.data[perm[i]];
+  }
+
+  int64_t start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    tflite::reference_ops::Transpose(params, dims.shape(), src,
+                                     out_dims.shape(), ref_out);
+  }
+  const int64_t ref_us = esp_timer_get_time() - start;
+
+  const tflite::esp_nn_layout::TransposePlan plan =
+      tflite::esp_nn_layout::BuildTransposePlan(params, dims.shape(), 1);
+  if (plan.kind == tflite::esp_nn_layout::TransposeKind::kReference) {
+    printf("%-32s falls back to reference\n", name);
+    return;
+  }
+  start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    tflite::esp_nn_layout::TransposeWithPlan(
+        plan, reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(opt_out));
+  }
+  Report(name, ref_us, esp_timer_get_time() - start, dims.flat_size());
+}
+
+void BenchmarkStridedSlice(const char* name, const Dims& dims,
+                           const int* begin, const int* end,
+                           uint16_t shrink_axis_mask) {
+  tflite::StridedSliceParams params = {};
+  params.start_indices_count = dims.size;
+  params.stop_indices_count = dims.size;
+  params.strides_count = dims.size;
+  for (int i = 0; i < dims.size; ++i) {
+    params.start_indices[i] = begin[i];
+    params.stop_indices[i] = end[i];
+    params.strides[i] = 1;
+  }
+  params.shrink_axis_mask = shrink_axis_mask;
+
+  // The reference kernel writes its output sequentially and ignores the
+  // output shape.
+  int64_t start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    tflite::reference_ops::StridedSlice(params, dims.shape(), src,
+                                        dims.shape(), ref_out);
+  }
+  const int64_t ref_us = esp_timer_get_time() - start;
+
+  tflite::esp_nn_layout::CopySpan spans[tflite::esp_nn_layout::kMaxCopySpans];
+  const int span_count = tflite::esp_nn_layout::BuildStridedSliceSpans(
+      params, dims.shape(), 1, spans);
+  if (span_count < 0) {
+    printf("%-32s falls back to reference\n", name);
+    return;
+  }
+  int bytes = 0;
+  for (int i = 0; i < span_count; ++i) bytes += spans[i].bytes;
+  start = esp_timer_get_time();
+  for (int it = 0; it < kIterations; ++it) {
+    tflite::esp_nn_layout::CopySpans(spans, span_count,
+                                     reinterpret_cast<const uint8_t*>(src),
+                                     reinterpret_cast<uint8_t*>(opt_out));
+  }
+  Report(name, ref_us, esp_timer_get_time() - start, bytes);
+}
+
+void RunBenchmarks() {
+  for (int i = 0; i < kMaxBytes; ++i) {
+    src[i] = static_cast<int8_t>(rand());
+  }
+  printf("layout ops, int8, %d iterations each\n", kIterations);
+
+  BenchmarkSplit("split [1,64] -> 4x[1,16]", {2, {1, 64}}, 1, 4);
+  BenchmarkSplit("unpack [24,1,3] -> 24x[1,3]", {3, {24, 1, 3}}, 0, 24);
+  BenchmarkSplit("unpack [24,1,16] -> 24x[1,16]", {3, {24, 1, 16}}, 0, 24);
+  BenchmarkSplit("unpack [6,1,32] -> 6x[1,32]", {3, {6, 1, 32}}, 0, 6);
+  BenchmarkPack("pack 24x[1,16] -> [24,1,16]", {3, {24, 1, 16}}, 0, 24);
+  BenchmarkPack("pack 6x[1,16] -> [6,1,16]", {3, {6, 1, 16}}, 0, 6);
+
+  const int perm_021[] = {0, 2, 1};
+  const int perm_102[] = {1, 0, 2};
+  const int perm_10[] = {1, 0};
+  BenchmarkTranspose("transpose [1,24,3] (0,2,1)", {3, {1, 24, 3}}, perm_021);
+  BenchmarkTranspose("transpose [24,1,16] (1,0,2)", {3, {24, 1, 16}},
+                     perm_102);
+  BenchmarkTranspose("transpose [24,16] (1,0)", {2, {24, 16}}, perm_10);
+  BenchmarkTranspose("transpose [64,48] (1,0)", {2, {64, 48}}, perm_10);
+
+  const int window_begin[] = {0, 18, 0};
+  const int window_end[] = {1, 24, 3};
+  BenchmarkStridedSlice("slice [1,24,3] last 6 steps", {3, {1, 24, 3}},
+                        window_begin, window_end, 0);
+  const int last_begin[] = {0, -1, 0};
+  const int last_end[] = {1, 0, 32};
+  BenchmarkStridedSlice("slice [1,6,32] last step", {3, {1, 6, 32}},
+                        last_begin, last_end, 0x2);
+}
+
+}  // namespace
+
+extern "C" void app_main(void) {
+  RunBenchmarks();
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+}
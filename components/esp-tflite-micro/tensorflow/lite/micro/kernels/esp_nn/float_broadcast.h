@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_FLOAT_BROADCAST_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_FLOAT_BROADCAST_H_
+
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Shape classification for the esp_nn float32 Add and Mul kernels. Both ops
+// are commutative, so a broadcast of either input maps onto the same
+// esp_nn_*_broadcast_f32 call with the inputs swapped.
+
+namespace tflite {
+namespace esp_nn_float {
+
+enum class BroadcastKind {
+  kElementwise,     // Same shape, no index math.
+  kBroadcastInput2, // Input2 is a scalar or a row repeated over input1.
+  kBroadcastInput1, // Input1 is a scalar or a row repeated over input2.
+  kReference,       // Anything else: use the generic 4D broadcast.
+};
+
+struct BroadcastPlan {
+  BroadcastKind kind;
+  int outer_size;
+  int row_len;
+};
+
+// True if `small`, with leading 1s dropped, matches the trailing dims of
+// `output`, i.e. `small` repeats unchanged over the outer dims of `output`.
+inline bool IsTrailingRow(const RuntimeShape& small,
+                          const RuntimeShape& output) {
+  int first = 0;
+  while (first < small.DimensionsCount() && small.Dims(first) == 1) {
+    ++first;
+  }
+  const int count = small.DimensionsCount() - first;
+  if (count > output.DimensionsCount()) {
+    return false;
+  }
+  const int offset = output.DimensionsCount() - count;
+  for (int i = 0; i < count; ++i) {
+    if (small.Dims(first + i) != output.Dims(offset + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline BroadcastPlan BuildBroadcastPlan(const RuntimeShape& input1,
+                                        const RuntimeShape& input2,
+                                        const RuntimeShape& output) {
+  const int size1 = input1.FlatSize();
+  const int size2 = input2.FlatSize();
+  const int output_size = output.FlatSize();
+
+  // Broadcasting only ever grows the output, so equal flat sizes mean both
+  // inputs already have the output shape.
+  if (size1 == output_size && size2 == output_size) {
+    return {BroadcastKind::kElementwise, 1, output_size};
+  }
+  if (size1 == output_size && size2 > 0 && IsTrailingRow(input2, output)) {
+    return {BroadcastKind::kBroadcastInput2, output_size / size2, size2};
+  }
+  if (size2 == output_size && size1 > 0 && IsTrailingRow(input1, output)) {
+    return {BroadcastKind::kBroadcastInput1, output_size / size1, size1};
+  }
+  return {BroadcastKind::kReference, 0, 0};
+}
+
+}  // namespace esp_nn_float
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_FLOAT_BROADCAST_H_
@@ -0,0 +1,313 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Custom op "ESP_BLOCK_SPARSE_FULLY_CONNECTED": int8 fully connected layer
+// whose pruned weights are stored as 1x16 blocks in CSR order, so all-zero
+// blocks cost neither flash nor MACs.
+//
+// Inputs:
+//   0: input, int8 [..., row_len]
+//   1: block values, int8 [num_blocks, 16], per-channel quantized with one
+//      scale per output channel
+//   2: block row pointers, uint16 [out_channels + 1]
+//   3: block column indices, uint16 [num_blocks]
+//   4: bias, int32 [out_channels] (optional)
+// Output:
+//   0: output, int8 [..., out_channels]
+// Custom options (flexbuffer map):
+//   "fused_activation_function": TfLiteFusedActivation value (default none)
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/fully_connected.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#if ESP_NN
+#include <esp_nn.h>
+#endif
+
+#include <esp_timer.h>
+
+long long fc_block_sparse_total_time = 0;
+
+namespace tflite {
+namespace {
+
+constexpr int kInputTensor = 0;
+constexpr int kBlockValuesTensor = 1;
+constexpr int kBlockRowPtrTensor = 2;
+constexpr int kBlockColIdxTensor = 3;
+constexpr int kBiasTensor = 4;
+constexpr int kOutputTensor = 0;
+
+constexpr int kBlockLen = 16;
+
+struct OpDataBlockSparseFullyConnected {
+  TfLiteFusedActivation activation;
+  int32_t input_zero_point;
+  int32_t output_zero_point;
+  int32_t output_activation_min;
+  int32_t output_activation_max;
+  int32_t* per_channel_output_multiplier;
+  int32_t* per_channel_output_shift;
+};
+
+#if !ESP_NN
+void BlockSparseFullyConnectedPerChannel(
+    const int8_t* input_data, int32_t input_offset, int row_len,
+    const int8_t* block_data, const uint16_t* block_row_ptr,
+    const uint16_t* block_col_idx, const int32_t* bias_data,
+    int8_t* output_data, int out_channels, int32_t output_offset,
+    const int32_t* output_shift, const int32_t* output_multiplier,
+    int32_t output_activation_min, int32_t output_activation_max) {
+  for (int out_c = 0; out_c < out_channels; ++out_c) {
+    int32_t acc = 0;
+    for (int blk = block_row_ptr[out_c]; blk < block_row_ptr[out_c + 1];
+         ++blk) {
+      const int col = block_col_idx[blk] * kBlockLen;
+      const int len = std::min(row_len - col, kBlockLen);
+      const int8_t* filter = block_data + blk * kBlockLen;
+      for (int i = 0; i < len; ++i) {
+        acc += filter[i] * (input_data[col + i] + input_offset);
+      }
+    }
+    if (bias_data != nullptr) {
+      acc += bias_data[out_c];
+    }
+    acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[out_c],
+                                        output_shift[out_c]);
+    acc += output_offset;
+    acc = std::max(acc, output_activation_min);
+    acc = std::min(acc, output_activation_max);
+    output_data[out_c] = static_cast<int8_t>(acc);
+  }
+}
+#endif
+
+// Eval indexes the block values and column indices through the row
+// pointers, and the input through the column indices, without checks. Both
+// index tensors are constant, so they are validated once here.
+TfLiteStatus ValidateBlockIndices(TfLiteContext* context,
+                                  const uint16_t* block_row_ptr,
+                                  int out_channels,
+                                  const uint16_t* block_col_idx,
+                                  int num_blocks, int row_len) {
+  TF_LITE_ENSURE_EQ(context, static_cast<int>(block_row_ptr[0]), 0);
+  for (int out_c = 0; out_c < out_channels; ++out_c) {
+    TF_LITE_ENSURE(context, block_row_ptr[out_c] <= block_row_ptr[out_c + 1]);
+  }
+  TF_LITE_ENSURE_EQ(context, static_cast<int>(block_row_ptr[out_channels]),
+                    num_blocks);
+  for (int blk = 0; blk < num_blocks; ++blk) {
+    TF_LITE_ENSURE(context, block_col_idx[blk] * kBlockLen < row_len);
+  }
+  return kTfLiteOk;
+}
+
+void* BlockSparseFullyConnectedInit(TfLiteContext* context,
+                                    const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  auto* data = static_cast<OpDataBlockSparseFullyConnected*>(
+      context->AllocatePersistentBuffer(
+          context, sizeof(OpDataBlockSparseFullyConnected)));
+
+  data->activation = kTfLiteActNone;
+  if (buffer != nullptr && length > 0) {
+    const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+    const flexbuffers::Map& m = flexbuffers::GetRoot(buffer_t, length).AsMap();
+    if (!m["fused_activation_function"].IsNull()) {
+      data->activation = static_cast<TfLiteFusedActivation>(
+          m["fused_activation_function"].AsInt32());
+    }
+  }
+  return data;
+}
+
+TfLiteStatus BlockSparseFullyConnectedPrepare(TfLiteContext* context,
+                                              TfLiteNode* node) {
+  MicroContext* micro_context = GetMicroContext(context);
+
+  TFLITE_DCHECK(node->user_data != nullptr);
+  auto* data = static_cast<OpDataBlockSparseFullyConnected*>(node->user_data);
+
+  TF_LITE_ENSURE(context, NumInputs(node) == 4 || NumInputs(node) == 5);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* values =
+      micro_context->AllocateTempInputTensor(node, kBlockValuesTensor);
+  TF_LITE_ENSURE(context, values != nullptr);
+  TfLiteTensor* row_ptr =
+      micro_context->AllocateTempInputTensor(node, kBlockRowPtrTensor);
+  TF_LITE_ENSURE(context, row_ptr != nullptr);
+  TfLiteTensor* col_idx =
+      micro_context->AllocateTempInputTensor(node, kBlockColIdxTensor);
+  TF_LITE_ENSURE(context, col_idx != nullptr);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+  TF_LITE_ENSURE_TYPES_EQ(context, values->type, kTfLiteInt8);
+  TF_LITE_ENSURE_TYPES_EQ(context, row_ptr->type, kTfLiteUInt16);
+  TF_LITE_ENSURE_TYPES_EQ(context, col_idx->type, kTfLiteUInt16);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+
+  TF_LITE_ENSURE_EQ(context, NumDimensions(values), 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(values, 1), kBlockLen);
+  TF_LITE_ENSURE_EQ(context, NumElements(col_idx),
+                    SizeOfDimension(values, 0));
+
+  const int out_channels = SizeOfDimension(output, NumDimensions(output) - 1);
+  TF_LITE_ENSURE_EQ(context, NumElements(row_ptr), out_channels + 1);
+
+  TF_LITE_ENSURE(context,
+                 IsConstantTensor(row_ptr) && IsConstantTensor(col_idx));
+  const int row_len = SizeOfDimension(input, NumDimensions(input) - 1);
+  TF_LITE_ENSURE_STATUS(ValidateBlockIndices(
+      context, GetTensorData<uint16_t>(row_ptr), out_channels,
+      GetTensorData<uint16_t>(col_idx),
+      static_cast<int>(NumElements(col_idx)), row_len));
+
+  // Skipping zero blocks is only exact for symmetric weights.
+  TF_LITE_ENSURE(context,
+                 values->quantization.type == kTfLiteAffineQuantization &&
+                     values->quantization.params != nullptr);
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(values->quantization.params);
+  TF_LITE_ENSURE(context, affine_quantization->scale != nullptr);
+  const int num_scales = affine_quantization->scale->size;
+  TF_LITE_ENSURE(context, num_scales == 1 || num_scales == out_channels);
+  TF_LITE_ENSURE_EQ(context, values->params.zero_point, 0);
+
+  data->per_channel_output_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, out_channels * sizeof(int32_t)));
+  data->per_channel_output_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, out_channels * sizeof(int32_t)));
+  TF_LITE_ENSURE(context, data->per_channel_output_multiplier != nullptr &&
+                              data->per_channel_output_shift != nullptr);
+
+  const float input_scale = input->params.scale;
+  const float output_scale = output->params.scale;
+  const float* filter_scales = affine_quantization->scale->data;
+  for (int i = 0; i < out_channels; ++i) {
+    const double filter_scale =
+        static_cast<double>(filter_scales[num_scales == 1 ? 0 : i]);
+    const double effective_output_scale = static_cast<double>(input_scale) *
+                                          filter_scale /
+                                          static_cast<double>(output_scale);
+    int32_t significand;
+    int channel_shift;
+    QuantizeMultiplier(effective_output_scale, &significand, &channel_shift);
+    data->per_channel_output_multiplier[i] = significand;
+    data->per_channel_output_shift[i] = channel_shift;
+  }
+
+  data->input_zero_point = input->params.zero_point;
+  data->output_zero_point = output->params.zero_point;
+  TF_LITE_ENSURE_STATUS(CalculateActivationRangeQuantized(
+      context, data->activation, output, &data->output_activation_min,
+      &data->output_activation_max));
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(values);
+  micro_context->DeallocateTempTfLiteTensor(row_ptr);
+  micro_context->DeallocateTempTfLiteTensor(col_idx);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+TfLiteStatus BlockSparseFullyConnectedEval(TfLiteContext* context,
+                                           TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const auto& data =
+      *(static_cast<const OpDataBlockSparseFullyConnected*>(node->user_data));
+
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* values =
+      tflite::micro::GetEvalInput(context, node, kBlockValuesTensor);
+  const TfLiteEvalTensor* row_ptr =
+      tflite::micro::GetEvalInput(context, node, kBlockRowPtrTensor);
+  const TfLiteEvalTensor* col_idx =
+      tflite::micro::GetEvalInput(context, node, kBlockColIdxTensor);
+  const TfLiteEvalTensor* bias =
+      (NumInputs(node) > kBiasTensor)
+          ? tflite::micro::GetEvalInput(context, node, kBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
+  const RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int out_channels = output_shape.Dims(output_dim_count - 1);
+  const int row_len = input_shape.Dims(input_shape.DimensionsCount() - 1);
+
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  const int8_t* block_data = tflite::micro::GetTensorData<int8_t>(values);
+  const uint16_t* block_row_ptr =
+      tflite::micro::GetTensorData<uint16_t>(row_ptr);
+  const uint16_t* block_col_idx =
+      tflite::micro::GetTensorData<uint16_t>(col_idx);
+  const int32_t* bias_data =
+      tflite::micro::GetOptionalTensorData<int32_t>(bias);
+
+  long long start_time = esp_timer_get_time();
+  for (int b = 0; b < batches; ++b) {
+#if ESP_NN
+    esp_nn_fully_connected_block_sparse_per_ch_s8(
+        input_data, -data.input_zero_point, row_len, block_data,
+        block_row_ptr, block_col_idx, bias_data, output_data, out_channels,
+        data.output_zero_point, data.per_channel_output_shift,
+        data.per_channel_output_multiplier, data.output_activation_min,
+        data.output_activation_max);
+#else
+    BlockSparseFullyConnectedPerChannel(
+        input_data, -data.input_zero_point, row_len, block_data,
+        block_row_ptr, block_col_idx, bias_data, output_data, out_channels,
+        data.output_zero_point, data.per_channel_output_shift,
+        data.per_channel_output_multiplier, data.output_activation_min,
+        data.output_activation_max);
+#endif
+    input_data += row_len;
+    output_data += out_channels;
+  }
+  fc_block_sparse_total_time += esp_timer_get_time() - start_time;
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration* Register_ESP_BLOCK_SPARSE_FULLY_CONNECTED() {
+  static TFLMRegistration r = tflite::micro::RegisterOp(
+      BlockSparseFullyConnectedInit, BlockSparseFullyConnectedPrepare,
+      BlockSparseFullyConnectedEval);
+  return &r;
+}
+
+}  // namespace tflite
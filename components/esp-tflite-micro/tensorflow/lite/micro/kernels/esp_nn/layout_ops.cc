@@ -0,0 +1,299 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/strided_slice_logic.h"
+
+namespace tflite {
+namespace esp_nn_layout {
+
+namespace {
+
+// Square tile used by the 2D transpose. 16x16 int8/int16/int32 tiles stay well
+// inside the 32 byte cache lines of both source and destination rows.
+constexpr int kTransposeTile = 16;
+
+template <typename T>
+void TiledTransposeTyped(const TransposePlan& plan, const uint8_t* input,
+                         uint8_t* output) {
+  const int rows = plan.rows;
+  const int cols = plan.cols;
+  const T* in = reinterpret_cast<const T*>(input);
+  T* out = reinterpret_cast<T*>(output);
+  for (int b = 0; b < plan.batch; ++b) {
+    for (int i0 = 0; i0 < rows; i0 += kTransposeTile) {
+      const int i1 = i0 + kTransposeTile < rows ? i0 + kTransposeTile : rows;
+      for (int j0 = 0; j0 < cols; j0 += kTransposeTile) {
+        const int j1 = j0 + kTransposeTile < cols ? j0 + kTransposeTile : cols;
+        for (int i = i0; i < i1; ++i) {
+          const T* in_row = in + i * cols;
+          for (int j = j0; j < j1; ++j) {
+            out[j * rows + i] = in_row[j];
+          }
+        }
+      }
+    }
+    in += rows * cols;
+    out += rows * cols;
+  }
+}
+
+void TiledTransposeBytes(const TransposePlan& plan, const uint8_t* input,
+                         uint8_t* output) {
+  const int rows = plan.rows;
+  const int cols = plan.cols;
+  const int inner = plan.inner_bytes;
+  const int plane = rows * cols * inner;
+  for (int b = 0; b < plan.batch; ++b) {
+    for (int i = 0; i < rows; ++i) {
+      const uint8_t* in_row = input + i * cols * inner;
+      for (int j = 0; j < cols; ++j) {
+        memcpy(output + (j * rows + i) * inner, in_row + j * inner, inner);
+      }
+    }
+    input += plane;
+    output += plane;
+  }
+}
+
+}  // namespace
+
+RunCopyPlan BuildRunCopyPlan(const TfLiteIntArray* dims, int axis,
+                             int part_count, int element_bytes) {
+  RunCopyPlan plan;
+  int32_t outer_size = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer_size *= dims->data[i];
+  }
+  int32_t inner_size = 1;
+  for (int i = axis + 1; i < dims->size; ++i) {
+    inner_size *= dims->data[i];
+  }
+  plan.outer_size = outer_size;
+  plan.copy_bytes =
+      (dims->data[axis] / part_count) * inner_size * element_bytes;
+  return plan;
+}
+
+void CopyPartFromStrided(const RunCopyPlan& plan, const uint8_t* strided,
+                         int part_index, int part_count, uint8_t* part) {
+  const int32_t bytes = plan.copy_bytes;
+  const int32_t stride = bytes * part_count;
+  strided += part_index * bytes;
+  if (plan.outer_size == 1) {
+    memcpy(part, strided, bytes);
+    return;
+  }
+  for (int k = 0; k < plan.outer_size; ++k) {
+    memcpy(part, strided, bytes);
+    part += bytes;
+    strided += stride;
+  }
+}
+
+void CopyPartToStrided(const RunCopyPlan& plan, const uint8_t* part,
+                       int part_index, int part_count, uint8_t* strided) {
+  const int32_t bytes = plan.copy_bytes;
+  const int32_t stride = bytes * part_count;
+  strided += part_index * bytes;
+  if (plan.outer_size == 1) {
+    memcpy(strided, part, bytes);
+    return;
+  }
+  for (int k = 0; k < plan.outer_size; ++k) {
+    memcpy(strided, part, bytes);
+    part += bytes;
+    strided += stride;
+  }
+}
+
+int BuildStridedSliceSpans(const StridedSliceParams& op_params,
+                           const RuntimeShape& unextended_input_shape,
+                           int element_bytes, CopySpan* spans) {
+  if (unextended_input_shape.DimensionsCount() > 5) {
+    return -1;
+  }
+  StridedSliceParams params = op_params;
+  const RuntimeShape input_shape =
+      RuntimeShape::ExtendedShape(5, unextended_input_shape);
+  strided_slice::StridedSlicePadIndices(&params, 5);
+
+  int32_t start[5];
+  int32_t stop[5];
+  int32_t stride[5];
+  for (int axis = 0; axis < 5; ++axis) {
+    stride[axis] = params.strides[axis];
+    start[axis] =
+        strided_slice::StridedSliceStartForAxis(params, input_shape, axis);
+    stop[axis] = strided_slice::StridedSliceEndForAxis(params, input_shape,
+                                                       axis, start[axis]);
+    // Reversed slices are left to the reference kernel.
+    if (stride[axis] <= 0) {
+      return -1;
+    }
+    if (start[axis] >= stop[axis]) {
+      return 0;
+    }
+  }
+  // The innermost axis has to be a contiguous run.
+  if (stride[4] != 1 && stop[4] - start[4] > 1) {
+    return -1;
+  }
+
+  int32_t axis_stride[5];
+  axis_stride[4] = element_bytes;
+  for (int axis = 3; axis >= 0; --axis) {
+    axis_stride[axis] = axis_stride[axis + 1] * input_shape.Dims(axis + 1);
+  }
+  const int32_t run_bytes = (stop[4] - start[4]) * element_bytes;
+
+  int span_count = 0;
+  for (int i0 = start[0]; i0 < stop[0]; i0 += stride[0]) {
+    for (int i1 = start[1]; i1 < stop[1]; i1 += stride[1]) {
+      for (int i2 = start[2]; i2 < stop[2]; i2 += stride[2]) {
+        for (int i3 = start[3]; i3 < stop[3]; i3 += stride[3]) {
+          const int32_t offset = i0 * axis_stride[0] + i1 * axis_stride[1] +
+                                 i2 * axis_stride[2] + i3 * axis_stride[3] +
+                                 start[4] * axis_stride[4];
+          if (span_count > 0) {
+            CopySpan& last = spans[span_count - 1];
+            if (last.src_offset + last.bytes == offset) {
+              last.bytes += run_bytes;
+              continue;
+            }
+          }
+          if (span_count == kMaxCopySpans) {
+            return -1;
+          }
+          spans[span_count].src_offset = offset;
+          spans[span_count].bytes = run_bytes;
+          ++span_count;
+        }
+      }
+    }
+  }
+  return span_count;
+}
+
+void CopySpans(const CopySpan* spans, int span_count, const uint8_t* src,
+               uint8_t* dst) {
+  for (int i = 0; i < span_count; ++i) {
+    memcpy(dst, src + spans[i].src_offset, spans[i].bytes);
+    dst += spans[i].bytes;
+  }
+}
+
+TransposePlan BuildTransposePlan(const TransposeParams& params,
+                                 const RuntimeShape& input_shape,
+                                 int element_bytes) {
+  TransposePlan plan = {};
+  plan.kind = TransposeKind::kReference;
+  plan.total_bytes = input_shape.FlatSize() * element_bytes;
+
+  const int dims = params.perm_count;
+  // Drop size-1 axes, renumbering the remaining input axes.
+  int new_index[kTransposeMaxDimensions];
+  int32_t sizes[kTransposeMaxDimensions];
+  int kept = 0;
+  for (int axis = 0; axis < dims; ++axis) {
+    if (input_shape.Dims(axis) == 1) {
+      new_index[axis] = -1;
+    } else {
+      new_index[axis] = kept;
+      sizes[kept++] = input_shape.Dims(axis);
+    }
+  }
+  int perm[kTransposeMaxDimensions];
+  int perm_count = 0;
+  for (int i = 0; i < dims; ++i) {
+    if (new_index[params.perm[i]] >= 0) {
+      perm[perm_count++] = new_index[params.perm[i]];
+    }
+  }
+
+  // Merge input axes that stay adjacent in the output. Each group is a run of
+  // consecutive input axes, so groups are renumbered by their first axis.
+  int group_first[kTransposeMaxDimensions];
+  int32_t group_elems[kTransposeMaxDimensions];
+  int group_count = 0;
+  for (int i = 0; i < perm_count; ++i) {
+    if (i == 0 || perm[i] != perm[i - 1] + 1) {
+      group_first[group_count] = perm[i];
+      group_elems[group_count++] = sizes[perm[i]];
+    } else {
+      group_elems[group_count - 1] *= sizes[perm[i]];
+    }
+  }
+  int32_t group_size[kTransposeMaxDimensions];
+  int reduced_perm[kTransposeMaxDimensions];
+  for (int g = 0; g < group_count; ++g) {
+    int rank = 0;
+    for (int h = 0; h < group_count; ++h) {
+      if (group_first[h] < group_first[g]) ++rank;
+    }
+    reduced_perm[g] = rank;
+    group_size[rank] = group_elems[g];
+  }
+
+  if (group_count <= 1) {
+    plan.kind = TransposeKind::kCopy;
+    return plan;
+  }
+
+  // After merging, the only cheap pattern left is a single swap of two axes,
+  // optionally with one untouched leading (batch) and trailing (inner) axis.
+  const int lead = reduced_perm[0] == 0 ? 1 : 0;
+  const int trail = reduced_perm[group_count - 1] == group_count - 1 ? 1 : 0;
+  if (group_count - lead - trail != 2 || reduced_perm[lead] != lead + 1 ||
+      reduced_perm[lead + 1] != lead) {
+    return plan;
+  }
+
+  plan.kind = TransposeKind::kTiled2D;
+  plan.batch = lead ? group_size[0] : 1;
+  plan.rows = group_size[lead];
+  plan.cols = group_size[lead + 1];
+  plan.inner_bytes =
+      element_bytes * (trail ? group_size[group_count - 1] : 1);
+  return plan;
+}
+
+void TransposeWithPlan(const TransposePlan& plan, const uint8_t* input,
+                       uint8_t* output) {
+  if (plan.kind == TransposeKind::kCopy) {
+    memcpy(output, input, plan.total_bytes);
+    return;
+  }
+  switch (plan.inner_bytes) {
+    case 1:
+      TiledTransposeTyped<uint8_t>(plan, input, output);
+      break;
+    case 2:
+      TiledTransposeTyped<uint16_t>(plan, input, output);
+      break;
+    case 4:
+      TiledTransposeTyped<uint32_t>(plan, input, output);
+      break;
+    default:
+      TiledTransposeBytes(plan, input, output);
+      break;
+  }
+}
+
+}  // namespace esp_nn_layout
+}  // namespace tflite
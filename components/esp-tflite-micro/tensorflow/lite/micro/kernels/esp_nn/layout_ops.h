@@ -0,0 +1,100 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_LAYOUT_OPS_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_LAYOUT_OPS_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Copy plans shared by the esp_nn Split, Pack, Unpack, StridedSlice and
+// Transpose kernels. Plans are built once in Prepare and cached in the op's
+// user_data so Eval only does memcpy calls (or a cache-tiled transpose).
+
+namespace tflite {
+namespace esp_nn_layout {
+
+// Split, Pack and Unpack all move `outer_size` runs of `copy_bytes` between
+// one tensor and each of N others. The strided side advances by
+// `copy_bytes * N` per run, the other side by `copy_bytes`.
+struct RunCopyPlan {
+  int32_t outer_size;
+  int32_t copy_bytes;
+};
+
+// Builds the run plan for an op that splits/concatenates along `axis`.
+// `dims` is the shape of the tensor holding all N parts, `part_count` is N.
+RunCopyPlan BuildRunCopyPlan(const TfLiteIntArray* dims, int axis,
+                             int part_count, int element_bytes);
+
+// Copies part `part_index` of `part_count` out of (or into) the strided side.
+void CopyPartFromStrided(const RunCopyPlan& plan, const uint8_t* strided,
+                         int part_index, int part_count, uint8_t* part);
+void CopyPartToStrided(const RunCopyPlan& plan, const uint8_t* part,
+                       int part_index, int part_count, uint8_t* strided);
+
+// One contiguous run of a StridedSlice. The destination is written
+// sequentially, so only the source offset is stored.
+struct CopySpan {
+  int32_t src_offset;
+  int32_t bytes;
+};
+
+// Largest number of spans cached per StridedSlice node. Slices that need more
+// spans (or have a non-unit inner stride) use the reference kernel.
+constexpr int kMaxCopySpans = 8;
+
+// Returns the number of spans written to `spans`, or -1 if the slice cannot be
+// expressed as at most kMaxCopySpans contiguous runs.
+int BuildStridedSliceSpans(const StridedSliceParams& op_params,
+                           const RuntimeShape& unextended_input_shape,
+                           int element_bytes, CopySpan* spans);
+
+void CopySpans(const CopySpan* spans, int span_count, const uint8_t* src,
+               uint8_t* dst);
+
+enum class TransposeKind : uint8_t {
+  kReference = 0,  // not reducible, use reference_ops::Transpose
+  kCopy,           // permutation only moves size-1 axes
+  kTiled2D,        // [batch][rows][cols] -> [batch][cols][rows]
+};
+
+struct TransposePlan {
+  TransposeKind kind;
+  int32_t batch;
+  int32_t rows;
+  int32_t cols;
+  // Bytes moved per transposed element. Larger than the tensor element size
+  // when trailing axes are not permuted ([1, 0, 2] style).
+  int32_t inner_bytes;
+  int32_t total_bytes;
+};
+
+// Collapses size-1 axes and axes that stay adjacent under `params` and
+// classifies the remaining permutation.
+TransposePlan BuildTransposePlan(const TransposeParams& params,
+                                 const RuntimeShape& input_shape,
+                                 int element_bytes);
+
+// Executes a kCopy or kTiled2D plan.
+void TransposeWithPlan(const TransposePlan& plan, const uint8_t* input,
+                       uint8_t* output);
+
+}  // namespace esp_nn_layout
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_ESP_NN_LAYOUT_OPS_H_
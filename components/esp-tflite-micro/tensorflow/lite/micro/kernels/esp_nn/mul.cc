@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/reference/process_broadcast_shapes.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/float_broadcast.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
 #include "tensorflow/lite/micro/micro_log.h"
@@ -76,6 +77,42 @@ void MulEvalQuantized(TfLiteContext* context, TfLiteNode* node,
                                                     tflite::micro::GetTensorShape(output)));
   }
 }
+
+// Same-shape, scalar and row-broadcast float muls. Returns false for shapes
+// that need the generic broadcast.
+bool MulEvalFloat(const OpDataMul* data, const TfLiteEvalTensor* input1,
+                  const TfLiteEvalTensor* input2, TfLiteEvalTensor* output) {
+  const esp_nn_float::BroadcastPlan plan = esp_nn_float::BuildBroadcastPlan(
+      tflite::micro::GetTensorShape(input1),
+      tflite::micro::GetTensorShape(input2),
+      tflite::micro::GetTensorShape(output));
+  const float* input1_data = tflite::micro::GetTensorData<float>(input1);
+  const float* input2_data = tflite::micro::GetTensorData<float>(input2);
+  float* out_data = tflite::micro::GetTensorData<float>(output);
+
+  switch (plan.kind) {
+    case esp_nn_float::BroadcastKind::kElementwise:
+      esp_nn_mul_elementwise_f32(input1_data, input2_data, out_data,
+                                 data->output_activation_min_f32,
+                                 data->output_activation_max_f32,
+                                 plan.row_len);
+      return true;
+    case esp_nn_float::BroadcastKind::kBroadcastInput2:
+      esp_nn_mul_broadcast_f32(input1_data, input2_data, out_data,
+                               data->output_activation_min_f32,
+                               data->output_activation_max_f32,
+                               plan.outer_size, plan.row_len);
+      return true;
+    case esp_nn_float::BroadcastKind::kBroadcastInput1:
+      esp_nn_mul_broadcast_f32(input2_data, input1_data, out_data,
+                               data->output_activation_min_f32,
+                               data->output_activation_max_f32,
+                               plan.outer_size, plan.row_len);
+      return true;
+    default:
+      return false;
+  }
+}
 #endif
 
 TfLiteStatus MulEval(TfLiteContext* context, TfLiteNode* node) {
@@ -106,6 +143,11 @@ TfLiteStatus MulEval(TfLiteContext* context, TfLiteNode* node) {
       EvalMulQuantizedReference(context, node, data, input1, input2, output);
       break;
     case kTfLiteFloat32:
+#if ESP_NN
+      if (MulEvalFloat(data, input1, input2, output)) {
+        break;
+      }
+#endif
       EvalMulFloatReference(context, node, params, data, input1, input2,
                             output);
       break;
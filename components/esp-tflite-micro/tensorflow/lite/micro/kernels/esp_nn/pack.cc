@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#include <esp_timer.h>
+
+long long pack_total_time = 0;
+
+namespace tflite {
+
+namespace {
+
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  esp_nn_layout::RunCopyPlan plan;
+};
+
+void* PackInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus PackPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const TfLitePackParams* params =
+      reinterpret_cast<TfLitePackParams*>(node->builtin_data);
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  switch (output->type) {
+    case kTfLiteFloat32:
+    case kTfLiteInt8:
+    case kTfLiteInt16:
+    case kTfLiteInt32:
+    case kTfLiteInt64:
+      break;
+    default:
+      MicroPrintf("Type '%s' is not supported by pack.",
+                  TfLiteTypeGetName(output->type));
+      return kTfLiteError;
+  }
+
+  int axis = params->axis;
+  if (axis < 0) {
+    axis += NumDimensions(output);
+  }
+  TF_LITE_ENSURE(context, axis >= 0 && axis < NumDimensions(output));
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), params->values_count);
+
+  size_t element_bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(output->type, &element_bytes));
+  data->plan = esp_nn_layout::BuildRunCopyPlan(
+      output->dims, axis, params->values_count, element_bytes);
+
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PackEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  long long start_time = esp_timer_get_time();
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  uint8_t* output_data = tflite::micro::GetTensorData<uint8_t>(output);
+  const int values_count = NumInputs(node);
+  for (int i = 0; i < values_count; ++i) {
+    const TfLiteEvalTensor* input =
+        tflite::micro::GetEvalInput(context, node, i);
+    esp_nn_layout::CopyPartToStrided(
+        data.plan, tflite::micro::GetTensorData<uint8_t>(input), i,
+        values_count, output_data);
+  }
+  pack_total_time += esp_timer_get_time() - start_time;
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_PACK() {
+  return tflite::micro::RegisterOp(PackInit, PackPrepare, PackEval);
+}
+
+}  // namespace tflite
@@ -0,0 +1,115 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#include <esp_timer.h>
+
+long long split_total_time = 0;
+
+namespace tflite {
+
+namespace {
+
+struct OpData {
+  esp_nn_layout::RunCopyPlan plan;
+};
+
+void* SplitInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus SplitPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* axis = micro_context->AllocateTempInputTensor(node, 0);
+  TF_LITE_ENSURE(context, axis != nullptr);
+
+  // Dynamic output tensors are needed if axis tensor is not constant.
+  // But Micro doesn't support dynamic memory allocation, so we only support
+  // constant axis tensor for now.
+  TF_LITE_ENSURE_MSG(context, IsConstantTensor(axis),
+                     "Non-constant >axis< tensor is not supported");
+
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, 1);
+  TF_LITE_ENSURE(context, input != nullptr);
+
+  int axis_value = GetTensorData<int32_t>(axis)[0];
+  if (axis_value < 0) {
+    axis_value += NumDimensions(input);
+  }
+  TF_LITE_ENSURE(context, axis_value >= 0);
+  TF_LITE_ENSURE(context, axis_value < NumDimensions(input));
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+    case kTfLiteInt8:
+    case kTfLiteInt16:
+    case kTfLiteInt32:
+      break;
+    default:
+      MicroPrintf("Type %s currently not supported.",
+                  TfLiteTypeGetName(input->type));
+      return kTfLiteError;
+  }
+
+  const int output_count = NumOutputs(node);
+  TF_LITE_ENSURE_EQ(context, input->dims->data[axis_value] % output_count, 0);
+  size_t element_bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(input->type, &element_bytes));
+  data->plan = esp_nn_layout::BuildRunCopyPlan(
+      input->dims, axis_value, output_count, element_bytes);
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(axis);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SplitEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  long long start_time = esp_timer_get_time();
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, 1);
+  const uint8_t* input_data = tflite::micro::GetTensorData<uint8_t>(input);
+  const int output_count = NumOutputs(node);
+  for (int i = 0; i < output_count; ++i) {
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, i);
+    esp_nn_layout::CopyPartFromStrided(
+        data.plan, input_data, i, output_count,
+        tflite::micro::GetTensorData<uint8_t>(output));
+  }
+  split_total_time += esp_timer_get_time() - start_time;
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_SPLIT() {
+  return tflite::micro::RegisterOp(SplitInit, SplitPrepare, SplitEval);
+}
+
+}  // namespace tflite
@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/reference/strided_slice.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/strided_slice.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#include <esp_timer.h>
+
+long long strided_slice_total_time = 0;
+
+namespace tflite {
+
+namespace {
+
+struct OpData {
+  // Must stay first: StridedSlicePrepare() fills user_data as a
+  // StridedSliceParams.
+  StridedSliceParams params;
+  // -1 when the slice is not a short list of contiguous runs.
+  int span_count;
+  esp_nn_layout::CopySpan spans[esp_nn_layout::kMaxCopySpans];
+};
+
+void* EspStridedSliceInit(TfLiteContext* context, const char* buffer,
+                          size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus EspStridedSlicePrepare(TfLiteContext* context,
+                                    TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(StridedSlicePrepare(context, node));
+
+  OpData* data = static_cast<OpData*>(node->user_data);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kStridedSliceInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+
+  size_t element_bytes;
+  if (TfLiteTypeSizeOf(input->type, &element_bytes) == kTfLiteOk) {
+    data->span_count = esp_nn_layout::BuildStridedSliceSpans(
+        data->params, GetTensorShape(input), element_bytes, data->spans);
+  } else {
+    data->span_count = -1;
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  return kTfLiteOk;
+}
+
+TfLiteStatus StridedSliceEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const StridedSliceParams& op_params = data.params;
+
+  long long start_time = esp_timer_get_time();
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kStridedSliceInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kStridedSliceOutputTensor);
+
+  if (data.span_count >= 0) {
+    esp_nn_layout::CopySpans(data.spans, data.span_count,
+                             tflite::micro::GetTensorData<uint8_t>(input),
+                             tflite::micro::GetTensorData<uint8_t>(output));
+    strided_slice_total_time += esp_timer_get_time() - start_time;
+    return kTfLiteOk;
+  }
+
+  switch (output->type) {
+    case kTfLiteFloat32:
+      reference_ops::StridedSlice(op_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<float>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<float>(output));
+      break;
+    case kTfLiteInt8:
+      reference_ops::StridedSlice(op_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<int8_t>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<int8_t>(output));
+      break;
+    case kTfLiteInt16:
+      reference_ops::StridedSlice(
+          op_params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<int16_t>(input),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<int16_t>(output));
+      break;
+    case kTfLiteInt32:
+      reference_ops::StridedSlice(
+          op_params, tflite::micro::GetTensorShape(input),
+          tflite::micro::GetTensorData<int32_t>(input),
+          tflite::micro::GetTensorShape(output),
+          tflite::micro::GetTensorData<int32_t>(output));
+      break;
+    case kTfLiteBool:
+      reference_ops::StridedSlice(op_params,
+                                  tflite::micro::GetTensorShape(input),
+                                  tflite::micro::GetTensorData<bool>(input),
+                                  tflite::micro::GetTensorShape(output),
+                                  tflite::micro::GetTensorData<bool>(output));
+      break;
+    default:
+      MicroPrintf("Type %s (%d) not supported.", TfLiteTypeGetName(input->type),
+                  input->type);
+      return kTfLiteError;
+  }
+  strided_slice_total_time += esp_timer_get_time() - start_time;
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_STRIDED_SLICE() {
+  return tflite::micro::RegisterOp(EspStridedSliceInit, EspStridedSlicePrepare,
+                                   StridedSliceEval);
+}
+
+}  // namespace tflite
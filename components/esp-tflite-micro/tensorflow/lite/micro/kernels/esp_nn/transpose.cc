@@ -0,0 +1,134 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/reference/transpose.h"
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/transpose.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#include <esp_timer.h>
+
+long long transpose_total_time = 0;
+
+namespace tflite {
+namespace {
+
+struct OpData {
+  TransposeParams params;
+  esp_nn_layout::TransposePlan plan;
+};
+
+void* TransposeInit(TfLiteContext* context, const char* buffer,
+                    size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus EspTransposePrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(TransposePrepare(context, node));
+
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  TransposeContext op_context(context, node);
+
+  // The perm tensor is constant (checked by TransposePrepare), so the
+  // params and the reduced copy plan are resolved once here.
+  const int32_t* perm_data = GetTensorData<int32_t>(op_context.perm);
+  const int size = op_context.perm->dims->data[0];
+  data->params.perm_count = size;
+  for (int i = 0; i < size; ++i) {
+    data->params.perm[i] = perm_data[i];
+  }
+
+  size_t element_bytes;
+  TF_LITE_ENSURE_STATUS(
+      TfLiteTypeSizeOf(op_context.input->type, &element_bytes));
+  data->plan = esp_nn_layout::BuildTransposePlan(
+      data->params, GetTensorShape(op_context.input), element_bytes);
+  return kTfLiteOk;
+}
+
+TfLiteStatus TransposeEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+  const TransposeParams& params = data.params;
+
+  long long start_time = esp_timer_get_time();
+  // Transpose kernel only does rearranging values not numeric evaluations
+  // on each cell. It's safe to implement per size of scalar type and this
+  // trick keeps the total code size in a reasonable range.
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kTransposeInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kTransposeOutputTensor);
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+    case kTfLiteInt8:
+    case kTfLiteInt16:
+      break;
+    default:
+      MicroPrintf(
+          "Type %s is currently not supported by Transpose. "
+          "Only float32, int8 and int16 are supported",
+          TfLiteTypeGetName(input->type));
+      return kTfLiteError;
+  }
+
+  if (data.plan.kind != esp_nn_layout::TransposeKind::kReference) {
+    esp_nn_layout::TransposeWithPlan(
+        data.plan, tflite::micro::GetTensorData<uint8_t>(input),
+        tflite::micro::GetTensorData<uint8_t>(output));
+    transpose_total_time += esp_timer_get_time() - start_time;
+    return kTfLiteOk;
+  }
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+      reference_ops::Transpose(params, tflite::micro::GetTensorShape(input),
+                               tflite::micro::GetTensorData<float>(input),
+                               tflite::micro::GetTensorShape(output),
+                               tflite::micro::GetTensorData<float>(output));
+      break;
+    case kTfLiteInt8:
+      reference_ops::Transpose(params, tflite::micro::GetTensorShape(input),
+                               tflite::micro::GetTensorData<int8_t>(input),
+                               tflite::micro::GetTensorShape(output),
+                               tflite::micro::GetTensorData<int8_t>(output));
+      break;
+    default:
+      reference_ops::Transpose(params, tflite::micro::GetTensorShape(input),
+                               tflite::micro::GetTensorData<int16_t>(input),
+                               tflite::micro::GetTensorShape(output),
+                               tflite::micro::GetTensorData<int16_t>(output));
+      break;
+  }
+  transpose_total_time += esp_timer_get_time() - start_time;
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_TRANSPOSE() {
+  return tflite::micro::RegisterOp(TransposeInit, EspTransposePrepare,
+                                   TransposeEval);
+}
+}  // namespace tflite
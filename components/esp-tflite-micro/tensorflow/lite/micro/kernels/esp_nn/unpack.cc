@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/esp_nn/layout_ops.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+#include <esp_timer.h>
+
+long long unpack_total_time = 0;
+
+namespace tflite {
+
+namespace {
+
+constexpr int kInputTensor = 0;
+
+struct OpData {
+  esp_nn_layout::RunCopyPlan plan;
+};
+
+void* UnpackInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(context, sizeof(OpData));
+}
+
+TfLiteStatus UnpackPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  OpData* data = static_cast<OpData*>(node->user_data);
+  const TfLiteUnpackParams* params =
+      reinterpret_cast<TfLiteUnpackParams*>(node->builtin_data);
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+
+  switch (input->type) {
+    case kTfLiteFloat32:
+    case kTfLiteInt32:
+    case kTfLiteInt16:
+    case kTfLiteInt8:
+      break;
+    default:
+      MicroPrintf("Type '%s' is not supported by unpack.",
+                  TfLiteTypeGetName(input->type));
+      return kTfLiteError;
+  }
+
+  int axis = params->axis;
+  if (axis < 0) {
+    axis += NumDimensions(input);
+  }
+  TF_LITE_ENSURE(context, axis >= 0 && axis < NumDimensions(input));
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), params->num);
+
+  size_t element_bytes;
+  TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(input->type, &element_bytes));
+  data->plan = esp_nn_layout::BuildRunCopyPlan(input->dims, axis, params->num,
+                                               element_bytes);
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  return kTfLiteOk;
+}
+
+TfLiteStatus UnpackEval(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData& data = *(static_cast<const OpData*>(node->user_data));
+
+  long long start_time = esp_timer_get_time();
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const uint8_t* input_data = tflite::micro::GetTensorData<uint8_t>(input);
+  const int output_count = NumOutputs(node);
+  for (int i = 0; i < output_count; ++i) {
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, i);
+    esp_nn_layout::CopyPartFromStrided(
+        data.plan, input_data, i, output_count,
+        tflite::micro::GetTensorData<uint8_t>(output));
+  }
+  unpack_total_time += esp_timer_get_time() - start_time;
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_UNPACK() {
+  return tflite::micro::RegisterOp(UnpackInit, UnpackPrepare, UnpackEval);
+}
+
+}  // namespace tflite
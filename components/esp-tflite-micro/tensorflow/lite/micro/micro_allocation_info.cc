@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/memory_helpers.h"
 #include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
 #include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_op_fusion.h"
 
 namespace tflite {
 
@@ -333,6 +334,42 @@ TfLiteStatus AllocationInfoBuilder::MarkAllocationLifetimes(
   return kTfLiteOk;
 }
 
+TfLiteStatus AllocationInfoBuilder::MarkFusedNodeLifetimes(
+    int subgraph_idx, SubgraphAllocations* allocations) {
+  const SubGraph* subgraph = model_->subgraphs()->Get(subgraph_idx);
+  AllocationInfo* subgraph_allocation_info =
+      &info_.allocation_info[info_.subgraph_offsets[subgraph_idx]];
+  const NodeAndRegistration* nodes =
+      allocations[subgraph_idx].node_and_registrations;
+
+  uint32_t operators_size = NumSubgraphOperators(subgraph);
+  for (uint32_t i = 0; i + 1 < operators_size; i++) {
+    if (!IsFusedIntoNextNode(nodes[i].registration)) {
+      continue;
+    }
+    // FuseOperators only fuses models with a single subgraph and no control
+    // flow, so node i was marked at allocation scope i + 1.
+    const int consumer_scope = static_cast<int>(i) + 2;
+    const auto* op = subgraph->operators()->Get(i);
+    for (size_t n = 0; op->inputs() != nullptr && n < op->inputs()->size();
+         ++n) {
+      const int tensor_index = op->inputs()->Get(n);
+      if (tensor_index >= 0) {
+        AllocationInfo* current = &subgraph_allocation_info[tensor_index];
+        if (current->needs_allocating && current->last_used < consumer_scope) {
+          UpdateLastUsed(current, consumer_scope);
+        }
+      }
+    }
+    // The intermediate only ever lives in the fused kernel's stack buffer.
+    for (size_t n = 0; op->outputs() != nullptr && n < op->outputs()->size();
+         ++n) {
+      subgraph_allocation_info[op->outputs()->Get(n)].needs_allocating = false;
+    }
+  }
+  return kTfLiteOk;
+}
+
 // Get offline tensors allocation plan. See
 // micro/docs/memory_management.md for more info.
 TfLiteStatus AllocationInfoBuilder::GetOfflinePlannedOffsets(
@@ -104,6 +104,13 @@ class AllocationInfoBuilder {
       ScratchBufferHandle* scratch_buffer_handles,
       SubgraphAllocations* allocations);
 
+  // Adjust the lifetimes marked by MarkAllocationLifetimes for nodes fused by
+  // FuseOperators. A fused pair runs entirely at the second node's scope, so
+  // the first node's inputs live one scope longer and its output is never
+  // materialized in the arena. Must be called after MarkAllocationLifetimes.
+  TfLiteStatus MarkFusedNodeLifetimes(int subgraph_idx,
+                                      SubgraphAllocations* allocations);
+
   // Returns the number of allocations.
   int AllocationCount() const { return info_.allocation_info_count; }
 
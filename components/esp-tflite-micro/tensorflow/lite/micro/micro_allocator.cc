@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/common.h"
@@ -59,23 +60,107 @@ constexpr int kUnassignedScratchBufferRequestIndex = -1;
 
 const TfLiteIntArray kZeroLengthIntArray = {};
 
+// Staging buffer and table of shared builtin data used in compact metadata
+// mode. Only allocated when compact mode is on.
+struct BuiltinDataInternTable {
+  // Covers every builtin params struct used by the common kernels; larger
+  // ones are allocated directly.
+  static constexpr size_t kStagingBytes = 48;
+  static constexpr size_t kMaxShared = 24;
+
+  struct Entry {
+    void* data;
+    size_t size;
+  };
+
+  alignas(std::max_align_t) uint8_t staging[kStagingBytes];
+  bool staging_in_use;
+  size_t staging_size;
+  size_t staging_alignment;
+  Entry shared[kMaxShared];
+  size_t shared_count;
+  size_t shared_hits;
+};
+
 class MicroBuiltinDataAllocator : public TfLiteBridgeBuiltinDataAllocator {
  public:
-  explicit MicroBuiltinDataAllocator(
-      IPersistentBufferAllocator* persistent_allocator)
-      : persistent_allocator_(persistent_allocator) {}
+  // `intern_table` is null unless compact metadata is enabled.
+  MicroBuiltinDataAllocator(IPersistentBufferAllocator* persistent_allocator,
+                            BuiltinDataInternTable* intern_table)
+      : persistent_allocator_(persistent_allocator),
+        intern_table_(intern_table) {}
 
   void* Allocate(size_t size, size_t alignment_hint) override {
-    return persistent_allocator_->AllocatePersistentBuffer(size,
-                                                           alignment_hint);
+    // In compact mode small builtin data is parsed into a staging buffer and
+    // only copied to the arena by Commit() if no identical copy exists yet.
+    BuiltinDataInternTable* table = intern_table_;
+    if (table != nullptr && !table->staging_in_use &&
+        size <= sizeof(table->staging) &&
+        alignment_hint <= alignof(std::max_align_t)) {
+      table->staging_in_use = true;
+      table->staging_size = size;
+      table->staging_alignment = alignment_hint;
+      // Zero padding bytes so identical params compare equal.
+      std::memset(table->staging, 0, size);
+      return table->staging;
+    }
+    return AllocatePersistent(size, alignment_hint);
   }
   void Deallocate(void* data) override {
     // Do not deallocate, builtin data needs to be available for the life time
     // of the model.
+    if (intern_table_ != nullptr && data == intern_table_->staging) {
+      intern_table_->staging_in_use = false;
+    }
+  }
+
+  // Returns the builtin data to store in the node. Data left in the staging
+  // buffer is replaced by a shared persistent copy.
+  void* Commit(void* data) {
+    BuiltinDataInternTable* table = intern_table_;
+    if (table == nullptr || data == nullptr || data != table->staging) {
+      return data;
+    }
+    table->staging_in_use = false;
+    for (size_t i = 0; i < table->shared_count; ++i) {
+      if (table->shared[i].size == table->staging_size &&
+          std::memcmp(table->shared[i].data, table->staging,
+                      table->staging_size) == 0) {
+        ++table->shared_hits;
+        return table->shared[i].data;
+      }
+    }
+    void* copy =
+        AllocatePersistent(table->staging_size, table->staging_alignment);
+    if (copy == nullptr) {
+      return nullptr;
+    }
+    std::memcpy(copy, table->staging, table->staging_size);
+    if (table->shared_count < BuiltinDataInternTable::kMaxShared) {
+      table->shared[table->shared_count].data = copy;
+      table->shared[table->shared_count].size = table->staging_size;
+      ++table->shared_count;
+    }
+    return copy;
+  }
+
+  size_t used_bytes() const { return used_bytes_; }
+  size_t shared_hits() const {
+    return intern_table_ != nullptr ? intern_table_->shared_hits : 0;
   }
 
  private:
+  void* AllocatePersistent(size_t size, size_t alignment) {
+    const size_t before = persistent_allocator_->GetPersistentUsedBytes();
+    void* data = persistent_allocator_->AllocatePersistentBuffer(size,
+                                                                 alignment);
+    used_bytes_ += persistent_allocator_->GetPersistentUsedBytes() - before;
+    return data;
+  }
+
   IPersistentBufferAllocator* persistent_allocator_;
+  BuiltinDataInternTable* intern_table_;
+  size_t used_bytes_ = 0;
 
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
@@ -634,12 +719,29 @@ SubgraphAllocations* MicroAllocator::StartModelAllocation(const Model* model) {
 
   model_is_allocating_ = true;
 
+  BuiltinDataInternTable* intern_table = nullptr;
+  if (compact_metadata_) {
+    const size_t persistent_before =
+        persistent_buffer_allocator_->GetPersistentUsedBytes();
+    uint8_t* intern_table_buffer =
+        persistent_buffer_allocator_->AllocatePersistentBuffer(
+            sizeof(BuiltinDataInternTable), alignof(BuiltinDataInternTable));
+    if (intern_table_buffer == nullptr) {
+      MicroPrintf("Failed to allocate memory for the builtin data table.");
+      return nullptr;
+    }
+    intern_table = new (intern_table_buffer) BuiltinDataInternTable();
+    persistent_usage_.builtin_data +=
+        persistent_buffer_allocator_->GetPersistentUsedBytes() -
+        persistent_before;
+  }
+
   uint8_t* data_allocator_buffer =
       persistent_buffer_allocator_->AllocatePersistentBuffer(
           sizeof(MicroBuiltinDataAllocator),
           alignof(MicroBuiltinDataAllocator));
   builtin_data_allocator_ = new (data_allocator_buffer)
-      MicroBuiltinDataAllocator(persistent_buffer_allocator_);
+      MicroBuiltinDataAllocator(persistent_buffer_allocator_, intern_table);
 
   if (InitScratchBufferData() != kTfLiteOk) {
     return nullptr;
@@ -688,8 +790,14 @@ TfLiteStatus MicroAllocator::FinishModelAllocation(
 }
 
 void* MicroAllocator::AllocatePersistentBuffer(size_t bytes) {
-  return persistent_buffer_allocator_->AllocatePersistentBuffer(
+  const size_t persistent_before =
+      persistent_buffer_allocator_->GetPersistentUsedBytes();
+  void* buffer = persistent_buffer_allocator_->AllocatePersistentBuffer(
       bytes, MicroArenaBufferAlignment());
+  persistent_usage_.persistent_buffers +=
+      persistent_buffer_allocator_->GetPersistentUsedBytes() -
+      persistent_before;
+  return buffer;
 }
 
 TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t bytes,
@@ -780,6 +888,8 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     uint32_t operators_size = NumSubgraphOperators(subgraph);
 
     // Initialize NodeAndRegistrations for the subgraph.
+    const size_t persistent_before =
+        persistent_buffer_allocator_->GetPersistentUsedBytes();
     NodeAndRegistration* output = reinterpret_cast<NodeAndRegistration*>(
         persistent_buffer_allocator_->AllocatePersistentBuffer(
             sizeof(NodeAndRegistration) * operators_size,
@@ -788,6 +898,9 @@ TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
       MicroPrintf("Failed to allocate memory for node_and_registrations.");
       return kTfLiteError;
     }
+    persistent_usage_.node_and_registrations +=
+        persistent_buffer_allocator_->GetPersistentUsedBytes() -
+        persistent_before;
     subgraph_allocations[subgraph_idx].node_and_registrations = output;
   }
   return kTfLiteOk;
@@ -801,6 +914,8 @@ TfLiteTensor* MicroAllocator::AllocatePersistentTfLiteTensor(
 
   // This value is allocated from persistent arena space. It is guaranteed to be
   // around for the lifetime of the application.
+  const size_t persistent_before =
+      persistent_buffer_allocator_->GetPersistentUsedBytes();
   TfLiteTensor* tensor = AllocatePersistentTfLiteTensorInternal();
 
   if (tensor == nullptr) {
@@ -819,6 +934,9 @@ TfLiteTensor* MicroAllocator::AllocatePersistentTfLiteTensor(
         "from flatbuffer data!");
     return nullptr;
   }
+  persistent_usage_.persistent_tensors +=
+      persistent_buffer_allocator_->GetPersistentUsedBytes() -
+      persistent_before;
 
   if (subgraph_allocations != nullptr) {
     // Tensor buffers that are allocated at runtime (e.g. non-weight buffers)
@@ -1044,6 +1162,8 @@ TfLiteStatus MicroAllocator::AllocateTfLiteEvalTensors(
     TFLITE_DCHECK(subgraph != nullptr);
 
     size_t alloc_count = subgraph->tensors()->size();
+    const size_t persistent_before =
+        persistent_buffer_allocator_->GetPersistentUsedBytes();
     TfLiteEvalTensor* tensors = reinterpret_cast<TfLiteEvalTensor*>(
         persistent_buffer_allocator_->AllocatePersistentBuffer(
             sizeof(TfLiteEvalTensor) * alloc_count, alignof(TfLiteEvalTensor)));
@@ -1054,6 +1174,9 @@ TfLiteStatus MicroAllocator::AllocateTfLiteEvalTensors(
           sizeof(TfLiteEvalTensor) * alloc_count);
       return kTfLiteError;
     }
+    persistent_usage_.eval_tensors +=
+        persistent_buffer_allocator_->GetPersistentUsedBytes() -
+        persistent_before;
 
     for (size_t i = 0; i < alloc_count; ++i) {
       TfLiteStatus status = internal::InitializeTfLiteEvalTensorFromFlatbuffer(
@@ -1080,9 +1203,14 @@ TfLiteStatus MicroAllocator::AllocateVariables(
         TF_LITE_ENSURE_STATUS(
             TfLiteEvalTensorByteLength(&eval_tensors[i], &buffer_size));
 
+        const size_t persistent_before =
+            persistent_buffer_allocator_->GetPersistentUsedBytes();
         eval_tensors[i].data.data =
             persistent_buffer_allocator_->AllocatePersistentBuffer(
                 buffer_size, MicroArenaBufferAlignment());
+        persistent_usage_.variable_buffers +=
+            persistent_buffer_allocator_->GetPersistentUsedBytes() -
+            persistent_before;
 
         if (eval_tensors[i].data.data == nullptr) {
           MicroPrintf("Failed to allocate variable tensor of size %d",
@@ -1155,6 +1283,7 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
       GetScratchBufferRequests();
   TF_LITE_ENSURE_STATUS(builder.MarkAllocationLifetimes(
       0, scratch_buffer_requests, scratch_buffer_handles, allocations));
+  TF_LITE_ENSURE_STATUS(builder.MarkFusedNodeLifetimes(0, allocations));
   int allocation_info_count = builder.AllocationCount();
   AllocationInfo* allocation_info = builder.Finish();
 
@@ -1222,10 +1351,15 @@ TfLiteStatus MicroAllocator::AllocateScratchBufferHandles(
 
   // Allocate a consecutive block of memory store the scratch buffer handles.
   // This alignment ensures quick lookup during inference time for the model:
+  const size_t persistent_before =
+      persistent_buffer_allocator_->GetPersistentUsedBytes();
   *scratch_buffer_handles = reinterpret_cast<ScratchBufferHandle*>(
       persistent_buffer_allocator_->AllocatePersistentBuffer(
           sizeof(ScratchBufferHandle) * handle_count,
           alignof(ScratchBufferHandle)));
+  persistent_usage_.scratch_handles +=
+      persistent_buffer_allocator_->GetPersistentUsedBytes() -
+      persistent_before;
 
   return kTfLiteOk;
 }
@@ -1258,4 +1392,37 @@ TfLiteBridgeBuiltinDataAllocator* MicroAllocator::GetBuiltinDataAllocator() {
   return builtin_data_allocator_;
 }
 
+void* MicroAllocator::CommitBuiltinData(void* builtin_data) {
+  TFLITE_DCHECK(builtin_data_allocator_ != nullptr);
+  return static_cast<MicroBuiltinDataAllocator*>(builtin_data_allocator_)
+      ->Commit(builtin_data);
+}
+
+TfLiteStatus MicroAllocator::SetCompactMetadata(bool enabled) {
+  if (builtin_data_allocator_ != nullptr) {
+    MicroPrintf(
+        "MicroAllocator: compact metadata must be set before the model is "
+        "allocated");
+    return kTfLiteError;
+  }
+  compact_metadata_ = enabled;
+  return kTfLiteOk;
+}
+
+PersistentArenaUsage MicroAllocator::GetPersistentArenaUsage() const {
+  PersistentArenaUsage usage = persistent_usage_;
+  if (builtin_data_allocator_ != nullptr) {
+    const MicroBuiltinDataAllocator* builtin_allocator =
+        static_cast<const MicroBuiltinDataAllocator*>(builtin_data_allocator_);
+    usage.builtin_data += builtin_allocator->used_bytes();
+    usage.shared_builtin_data = builtin_allocator->shared_hits();
+  }
+  usage.total = persistent_buffer_allocator_->GetPersistentUsedBytes();
+  usage.other = usage.total - usage.eval_tensors -
+                usage.node_and_registrations - usage.builtin_data -
+                usage.persistent_tensors - usage.variable_buffers -
+                usage.persistent_buffers - usage.scratch_handles;
+  return usage;
+}
+
 }  // namespace tflite
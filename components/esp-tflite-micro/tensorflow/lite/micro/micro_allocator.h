@@ -92,6 +92,25 @@ struct ScratchBufferHandle {
   uint8_t* data;
 };
 
+// Bytes taken from the persistent (tail) section of the arena, split by what
+// they hold. `persistent_buffers` are AllocatePersistentBuffer() calls made by
+// kernels and the interpreter; `other` is allocator, memory planner and
+// subgraph bookkeeping. Tensor dims alias the flatbuffer and take no arena.
+struct PersistentArenaUsage {
+  size_t eval_tensors;
+  size_t node_and_registrations;
+  // Includes the interning table in compact metadata mode.
+  size_t builtin_data;
+  size_t persistent_tensors;
+  size_t variable_buffers;
+  size_t persistent_buffers;
+  size_t scratch_handles;
+  size_t other;
+  size_t total;
+  // Nodes that reuse builtin data of an earlier node (compact metadata only).
+  size_t shared_builtin_data;
+};
+
 // Stores all per-subgraph allocations. This includes the node and registration
 // array, and tensor list for each subgraph.
 struct SubgraphAllocations {
@@ -259,6 +278,20 @@ class MicroAllocator {
 
   TfLiteBridgeBuiltinDataAllocator* GetBuiltinDataAllocator();
 
+  // Called by the interpreter with the builtin data parsed for a node. With
+  // compact metadata enabled, nodes whose params are byte-identical share a
+  // single persistent copy; otherwise `builtin_data` is returned unchanged.
+  void* CommitBuiltinData(void* builtin_data);
+
+  // Enables sharing of identical builtin data between nodes. Graphs unrolled
+  // over time repeat the same few params hundreds of times. Must be called
+  // before StartModelAllocation().
+  TfLiteStatus SetCompactMetadata(bool enabled);
+
+  // Returns the persistent arena usage per category. Complete after
+  // FinishModelAllocation().
+  PersistentArenaUsage GetPersistentArenaUsage() const;
+
  protected:
   MicroAllocator(SingleArenaBufferAllocator* memory_allocator,
                  MicroMemoryPlanner* memory_planner);
@@ -360,6 +393,10 @@ class MicroAllocator {
   // to ensure that multi-tenant allocations can share the head for buffers.
   size_t max_head_buffer_usage_ = 0;
 
+  bool compact_metadata_ = false;
+
+  PersistentArenaUsage persistent_usage_ = {};
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
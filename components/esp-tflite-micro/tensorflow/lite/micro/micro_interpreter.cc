@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_interpreter_context.h"
 #include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_op_fusion.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler_interface.h"
 #include "tensorflow/lite/micro/tflite_bridge/flatbuffer_conversions_bridge.h"
@@ -172,6 +173,11 @@ TfLiteStatus MicroInterpreter::PrepareNodeAndRegistrationDataFromFlatbuffer() {
         }
         TF_LITE_ENSURE_STATUS(CallBuiltinParseFunction(
             parser, op, builtin_data_allocator, (void**)(&builtin_data)));
+        if (builtin_data != nullptr) {
+          builtin_data = static_cast<unsigned char*>(
+              allocator_.CommitBuiltinData(builtin_data));
+          TF_LITE_ENSURE(&context_, builtin_data != nullptr);
+        }
       }
 
       TfLiteIntArray* inputs_array =
@@ -219,6 +225,11 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(graph_.PrepareSubgraphs());
 
+  if (operator_fusion_) {
+    TF_LITE_ENSURE_STATUS(FuseOperators(model_, graph_.GetAllocations(),
+                                        &allocator_, &fused_operator_count_));
+  }
+
   micro_context_.SetInterpreterState(
       MicroInterpreterContext::InterpreterState::kMemoryPlanning);
 
@@ -339,6 +350,19 @@ TfLiteStatus MicroInterpreter::SetAlternateProfiler(
   return micro_context_.SetAlternateProfiler(alt_profiler);
 }
 
+TfLiteStatus MicroInterpreter::SetCompactMetadata(bool enabled) {
+  return allocator_.SetCompactMetadata(enabled);
+}
+
+TfLiteStatus MicroInterpreter::SetOperatorFusion(bool enabled) {
+  if (tensors_allocated_) {
+    MicroPrintf("Operator fusion must be set before AllocateTensors");
+    return kTfLiteError;
+  }
+  operator_fusion_ = enabled;
+  return kTfLiteOk;
+}
+
 #ifdef USE_TFLM_COMPRESSION
 
 TfLiteStatus MicroInterpreter::SetDecompressionMemory(
@@ -152,6 +152,26 @@ class MicroInterpreter {
     return allocator_.preserves_all_tensor();
   }
 
+  // For debugging only.
+  // Returns the persistent arena usage per category. It's only complete after
+  // `AllocateTensors` has been called.
+  PersistentArenaUsage persistent_arena_usage() const {
+    return allocator_.GetPersistentArenaUsage();
+  }
+
+  // Shares byte-identical builtin data between nodes, which saves arena on
+  // graphs that repeat the same ops many times (e.g. unrolled RNNs). Must be
+  // called before `AllocateTensors`.
+  TfLiteStatus SetCompactMetadata(bool enabled);
+
+  // Merges adjacent int8 elementwise nodes (MUL -> ADD, LOGISTIC/TANH -> MUL)
+  // into fused kernels and drops their intermediate tensors from the memory
+  // plan. Must be called before `AllocateTensors`.
+  TfLiteStatus SetOperatorFusion(bool enabled);
+
+  // Returns the number of node pairs fused by `AllocateTensors`.
+  int fused_operator_count() const { return fused_operator_count_; }
+
   // Set the alternate MicroProfilerInterface.
   // This value is passed through to the MicroContext.
   // This can be used to profile subsystems simultaneously with the profiling
@@ -192,6 +212,9 @@ class MicroInterpreter {
 
   TfLiteStatus initialization_status_;
 
+  bool operator_fusion_ = false;
+  int fused_operator_count_ = 0;
+
   ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
 
   // TODO(b/162311891): Clean these pointers up when this class supports buffers
@@ -44,6 +44,7 @@ limitations under the License.
 
 namespace tflite {
 TFLMRegistration* Register_DETECTION_POSTPROCESS();
+TFLMRegistration* Register_ESP_BLOCK_SPARSE_FULLY_CONNECTED();
 
 template <unsigned int tOpCount>
 class MicroMutableOpResolver : public MicroOpResolver {
@@ -241,6 +242,11 @@ class MicroMutableOpResolver : public MicroOpResolver {
                      tflite::Register_DETECTION_POSTPROCESS());
   }
 
+  TfLiteStatus AddEspBlockSparseFullyConnected() {
+    return AddCustom("ESP_BLOCK_SPARSE_FULLY_CONNECTED",
+                     tflite::Register_ESP_BLOCK_SPARSE_FULLY_CONNECTED());
+  }
+
   TfLiteStatus AddDiv(
       const TFLMRegistration& registration = tflite::Register_DIV()) {
     return AddBuiltin(BuiltinOperator_DIV, registration, ParseDiv);
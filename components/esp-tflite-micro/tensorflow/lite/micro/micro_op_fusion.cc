@@ -0,0 +1,373 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_op_fusion.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/logistic.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/tanh.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/kernels/add.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/logistic.h"
+#include "tensorflow/lite/micro/kernels/mul.h"
+#include "tensorflow/lite/micro/kernels/tanh.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+#if ESP_NN
+#include <esp_nn.h>
+#endif
+
+namespace tflite {
+
+namespace {
+
+// The fused kernels stream the intermediate through a stack buffer of this
+// many elements. Chunks stay a multiple of 16 so the esp_nn SIMD paths see the
+// same alignment as the unfused kernels.
+constexpr int kFusedChunkSize = 128;
+
+enum class ActivationKind { kLogistic, kTanh };
+
+TfLiteStatus FusedIntoNextNodeEval(TfLiteContext* context, TfLiteNode* node) {
+  // The work is done by the next node.
+  return kTfLiteOk;
+}
+
+#if ESP_NN
+
+// Fused nodes always come in adjacent pairs, and NodeAndRegistration entries
+// are stored contiguously, so the producer is the node just before this one.
+const TfLiteNode* ProducerNode(const TfLiteNode* node) {
+  return &(reinterpret_cast<const NodeAndRegistration*>(node) - 1)->node;
+}
+
+// Index of the consumer input that reads the producer's output.
+int IntermediateSlot(const TfLiteNode* node, const TfLiteNode* producer) {
+  return node->inputs->data[0] == producer->outputs->data[0] ? 0 : 1;
+}
+
+void MulChunk(const OpDataMul* data, const int8_t* input1,
+              const int8_t* input2, int8_t* output, int size) {
+  esp_nn_mul_elementwise_s8(input1, input2, -data->input1_zero_point,
+                            -data->input2_zero_point, output,
+                            data->output_zero_point, data->output_multiplier,
+                            data->output_shift, data->output_activation_min,
+                            data->output_activation_max, size);
+}
+
+void AddChunk(const OpDataAdd* data, const int8_t* input1,
+              const int8_t* input2, int8_t* output, int size) {
+  esp_nn_add_elementwise_s8(input1, input2, data->input1_offset,
+                            data->input2_offset, data->input1_multiplier,
+                            data->input2_multiplier, data->input1_shift,
+                            data->input2_shift, data->left_shift, output,
+                            data->output_offset, data->output_multiplier,
+                            data->output_shift, data->output_activation_min,
+                            data->output_activation_max, size);
+}
+
+TfLiteStatus MulAddEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteNode* mul_node = ProducerNode(node);
+  TFLITE_DCHECK(mul_node->user_data != nullptr);
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpDataMul* mul_data = static_cast<const OpDataMul*>(mul_node->user_data);
+  const OpDataAdd* add_data = static_cast<const OpDataAdd*>(node->user_data);
+
+  const int slot = IntermediateSlot(node, mul_node);
+  const int8_t* mul_input1 = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, mul_node, 0));
+  const int8_t* mul_input2 = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, mul_node, 1));
+  const int8_t* addend = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 1 - slot));
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  const int size = ElementCount(*output->dims);
+
+  alignas(16) int8_t product[kFusedChunkSize];
+  for (int base = 0; base < size; base += kFusedChunkSize) {
+    const int count = std::min(kFusedChunkSize, size - base);
+    MulChunk(mul_data, mul_input1 + base, mul_input2 + base, product, count);
+    if (slot == 0) {
+      AddChunk(add_data, product, addend + base, output_data + base, count);
+    } else {
+      AddChunk(add_data, addend + base, product, output_data + base, count);
+    }
+  }
+  return kTfLiteOk;
+}
+
+template <ActivationKind kActivation>
+TfLiteStatus ActivationMulEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteNode* activation_node = ProducerNode(node);
+  TFLITE_DCHECK(activation_node->user_data != nullptr);
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpDataMul* mul_data = static_cast<const OpDataMul*>(node->user_data);
+
+  const int slot = IntermediateSlot(node, activation_node);
+  const int8_t* activation_input = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, activation_node, 0));
+  const int8_t* factor = tflite::micro::GetTensorData<int8_t>(
+      tflite::micro::GetEvalInput(context, node, 1 - slot));
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  const int size = ElementCount(*output->dims);
+
+  alignas(16) int8_t activated[kFusedChunkSize];
+  for (int base = 0; base < size; base += kFusedChunkSize) {
+    const int32_t count = std::min(kFusedChunkSize, size - base);
+    if (kActivation == ActivationKind::kLogistic) {
+      const OpDataLogistic* data =
+          static_cast<const OpDataLogistic*>(activation_node->user_data);
+      reference_integer_ops::Logistic(
+          data->input_zero_point, data->input_range_radius,
+          data->input_multiplier, data->input_left_shift, count,
+          activation_input + base, activated);
+    } else {
+      const OpDataTanh* data =
+          static_cast<const OpDataTanh*>(activation_node->user_data);
+      const RuntimeShape chunk_shape(1, &count);
+      reference_integer_ops::Tanh(
+          data->input_zero_point, data->input_range_radius,
+          data->input_multiplier, data->input_left_shift, chunk_shape,
+          activation_input + base, chunk_shape, activated);
+    }
+    if (slot == 0) {
+      MulChunk(mul_data, activated, factor + base, output_data + base, count);
+    } else {
+      MulChunk(mul_data, factor + base, activated, output_data + base, count);
+    }
+  }
+  return kTfLiteOk;
+}
+
+#endif  // ESP_NN
+
+TFLMRegistration FusedRegistration(
+    TfLiteStatus (*invoke)(TfLiteContext* context, TfLiteNode* node),
+    const char* name) {
+  TFLMRegistration registration =
+      tflite::micro::RegisterOp(nullptr, nullptr, invoke);
+  registration.builtin_code = BuiltinOperator_CUSTOM;
+  registration.custom_name = name;
+  return registration;
+}
+
+const TFLMRegistration* FusedIntoNextNodeRegistration() {
+  static const TFLMRegistration registration =
+      FusedRegistration(FusedIntoNextNodeEval, "FUSED_INTO_NEXT");
+  return &registration;
+}
+
+#if ESP_NN
+
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+
+const TFLMRegistration* MulAddRegistration() {
+  static const TFLMRegistration registration =
+      FusedRegistration(MulAddEval, "MUL_ADD");
+  return &registration;
+}
+
+const TFLMRegistration* LogisticMulRegistration() {
+  static const TFLMRegistration registration = FusedRegistration(
+      ActivationMulEval<ActivationKind::kLogistic>, "LOGISTIC_MUL");
+  return &registration;
+}
+
+const TFLMRegistration* TanhMulRegistration() {
+  static const TFLMRegistration registration = FusedRegistration(
+      ActivationMulEval<ActivationKind::kTanh>, "TANH_MUL");
+  return &registration;
+}
+
+bool HasOfflinePlan(const Model* model) {
+  if (model->metadata() == nullptr) {
+    return false;
+  }
+  for (size_t i = 0; i < model->metadata()->size(); ++i) {
+    const auto* metadata = model->metadata()->Get(i);
+    if (metadata->name() != nullptr &&
+        strcmp(metadata->name()->c_str(), kOfflineMemAllocMetadata) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AllInt8(const TfLiteIntArray* indices, const TfLiteEvalTensor* tensors) {
+  for (int i = 0; i < indices->size; ++i) {
+    if (indices->data[i] < 0 || tensors[indices->data[i]].type != kTfLiteInt8) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AllOfSize(const TfLiteIntArray* indices, const TfLiteEvalTensor* tensors,
+               int size) {
+  for (int i = 0; i < indices->size; ++i) {
+    if (ElementCount(*tensors[indices->data[i]].dims) != size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks everything a fused pair relies on: the producer's only output feeds
+// the consumer and nothing else, both nodes are plain two-input (or one-input
+// activation) int8 elementwise ops without broadcast, and neither kernel needs
+// its free/reset hooks, which the fused registrations don't forward.
+bool CanFuse(const NodeAndRegistration& producer,
+             const NodeAndRegistration& consumer,
+             const TfLiteEvalTensor* tensors, const uint16_t* consumer_counts) {
+  const TfLiteNode& producer_node = producer.node;
+  const TfLiteNode& consumer_node = consumer.node;
+  if (producer.registration->free != nullptr ||
+      producer.registration->reset != nullptr ||
+      consumer.registration->free != nullptr ||
+      consumer.registration->reset != nullptr) {
+    return false;
+  }
+  if (producer_node.outputs->size != 1 || consumer_node.outputs->size != 1 ||
+      consumer_node.inputs->size != 2) {
+    return false;
+  }
+  const int intermediate = producer_node.outputs->data[0];
+  if (consumer_counts[intermediate] != 1 ||
+      (consumer_node.inputs->data[0] != intermediate &&
+       consumer_node.inputs->data[1] != intermediate)) {
+    return false;
+  }
+  if (!AllInt8(producer_node.inputs, tensors) ||
+      !AllInt8(producer_node.outputs, tensors) ||
+      !AllInt8(consumer_node.inputs, tensors) ||
+      !AllInt8(consumer_node.outputs, tensors)) {
+    return false;
+  }
+  const int size = ElementCount(*tensors[intermediate].dims);
+  return AllOfSize(producer_node.inputs, tensors, size) &&
+         AllOfSize(consumer_node.inputs, tensors, size) &&
+         AllOfSize(consumer_node.outputs, tensors, size);
+}
+
+const TFLMRegistration* ActivationMulRegistration(int32_t builtin_code) {
+  switch (builtin_code) {
+    case BuiltinOperator_LOGISTIC:
+      return LogisticMulRegistration();
+    case BuiltinOperator_TANH:
+      return TanhMulRegistration();
+    default:
+      return nullptr;
+  }
+}
+
+#endif  // ESP_NN
+
+}  // namespace
+
+bool IsFusedIntoNextNode(const TFLMRegistration* registration) {
+  return registration == FusedIntoNextNodeRegistration();
+}
+
+TfLiteStatus FuseOperators(const Model* model,
+                           SubgraphAllocations* allocations,
+                           MicroAllocator* allocator, int* fused_count) {
+  TFLITE_DCHECK(fused_count != nullptr);
+  *fused_count = 0;
+#if ESP_NN
+  // Fused kernels never enter another subgraph and rely on the online planner
+  // to honour the lifetimes set by MarkFusedNodeLifetimes. Preserved tensors
+  // must all hold real values, which the dropped intermediates wouldn't.
+  if (model->subgraphs()->size() != 1 || HasOfflinePlan(model) ||
+      allocator->preserves_all_tensor()) {
+    return kTfLiteOk;
+  }
+
+  const SubGraph* subgraph = model->subgraphs()->Get(0);
+  const uint32_t operators_size = NumSubgraphOperators(subgraph);
+  const size_t tensors_size = subgraph->tensors()->size();
+  NodeAndRegistration* nodes = allocations[0].node_and_registrations;
+  const TfLiteEvalTensor* tensors = allocations[0].tensors;
+
+  // Number of reads of every tensor, with subgraph outputs counted as a read
+  // so that they are never treated as private intermediates.
+  uint16_t* consumer_counts =
+      reinterpret_cast<uint16_t*>(allocator->AllocateTempBuffer(
+          tensors_size * sizeof(uint16_t), alignof(uint16_t)));
+  if (consumer_counts == nullptr) {
+    MicroPrintf("Operator fusion skipped: no room for %d consumer counts",
+                tensors_size);
+    return kTfLiteOk;
+  }
+  memset(consumer_counts, 0, tensors_size * sizeof(uint16_t));
+  for (uint32_t i = 0; i < operators_size; ++i) {
+    const TfLiteIntArray* inputs = nodes[i].node.inputs;
+    for (int n = 0; n < inputs->size; ++n) {
+      if (inputs->data[n] >= 0) {
+        ++consumer_counts[inputs->data[n]];
+      }
+    }
+  }
+  for (size_t i = 0; subgraph->outputs() != nullptr &&
+                     i < subgraph->outputs()->size();
+       ++i) {
+    ++consumer_counts[subgraph->outputs()->Get(i)];
+  }
+
+  // MUL -> ADD first: where a MUL sits between an activation and an ADD it is
+  // cheaper to hand it to the ADD, as the activation keeps its own output
+  // buffer either way.
+  for (uint32_t i = 1; i < operators_size; ++i) {
+    NodeAndRegistration& producer = nodes[i - 1];
+    NodeAndRegistration& consumer = nodes[i];
+    if (producer.registration->builtin_code == BuiltinOperator_MUL &&
+        consumer.registration->builtin_code == BuiltinOperator_ADD &&
+        CanFuse(producer, consumer, tensors, consumer_counts)) {
+      producer.registration = FusedIntoNextNodeRegistration();
+      consumer.registration = MulAddRegistration();
+      ++(*fused_count);
+    }
+  }
+  // Fused nodes carry BuiltinOperator_CUSTOM from here on, so a MUL taken by
+  // the first pass can't be picked up again.
+  for (uint32_t i = 1; i < operators_size; ++i) {
+    NodeAndRegistration& producer = nodes[i - 1];
+    NodeAndRegistration& consumer = nodes[i];
+    const TFLMRegistration* fused =
+        ActivationMulRegistration(producer.registration->builtin_code);
+    if (fused != nullptr &&
+        consumer.registration->builtin_code == BuiltinOperator_MUL &&
+        producer.node.inputs->size == 1 &&
+        CanFuse(producer, consumer, tensors, consumer_counts)) {
+      producer.registration = FusedIntoNextNodeRegistration();
+      consumer.registration = fused;
+      ++(*fused_count);
+    }
+  }
+
+  allocator->DeallocateTempBuffer(reinterpret_cast<uint8_t*>(consumer_counts));
+#endif  // ESP_NN
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,51 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_OP_FUSION_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_OP_FUSION_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Init-time operator fusion for int8 graphs.
+//
+// Looks for a node whose single output is consumed only by the node directly
+// after it, and merges the pair into one kernel that streams the intermediate
+// through a small stack buffer instead of the arena:
+//   MUL -> ADD                 : fused multiply-add
+//   LOGISTIC -> MUL, TANH -> MUL : activation with a multiply epilogue
+// The first node of a pair keeps its place in the graph but its registration is
+// swapped for a no-op, so node indices (and everything keyed on them, e.g.
+// scratch buffer requests) stay valid. The memory planner then drops the
+// intermediate tensor, see AllocationInfoBuilder::MarkFusedNodeLifetimes.
+//
+// Must run after all nodes are prepared and before the memory plan is
+// committed. Only single-subgraph, online-planned models are fused; anything
+// else is left untouched. `fused_count` receives the number of fused pairs.
+TfLiteStatus FuseOperators(const Model* model,
+                           SubgraphAllocations* allocations,
+                           MicroAllocator* allocator, int* fused_count);
+
+// True if `registration` is the no-op left behind by a node that was fused
+// into the node that follows it.
+bool IsFusedIntoNextNode(const TFLMRegistration* registration);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_OP_FUSION_H_
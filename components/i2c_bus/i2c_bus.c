@@ -229,6 +229,33 @@ uint8_t i2c_bus_device_get_address(i2c_bus_device_handle_t dev_handle)
     return i2c_device->dev_addr;
 }
 
+esp_err_t i2c_bus_device_get_stats(i2c_bus_device_handle_t dev_handle, i2c_bus_device_stats_t *stats)
+{
+    I2C_BUS_CHECK(dev_handle != NULL && stats != NULL, "device handle error", ESP_ERR_INVALID_ARG);
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_bus_device_reset_stats(i2c_bus_device_handle_t dev_handle)
+{
+    I2C_BUS_CHECK(dev_handle != NULL, "device handle error", ESP_ERR_INVALID_ARG);
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_bus_async_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_bus_submit(const i2c_bus_segment_t *segments, size_t count, i2c_bus_batch_cb_t cb, void *user_ctx)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_bus_async_wait_idle(uint32_t timeout_ms)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t i2c_bus_read_bytes(i2c_bus_device_handle_t dev_handle, uint8_t mem_address, size_t data_len, uint8_t *data)
 {
     return i2c_bus_read_reg8(dev_handle, mem_address, data_len, data);
@@ -10,8 +10,14 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
 
 #include "esp_log.h"
+#if CONFIG_I2C_BUS_DEVICE_STATS
+#include "esp_timer.h"
+#endif
 #include "i2c_bus.h"
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
 #include "i2c_bus_soft.h"
@@ -24,6 +30,17 @@
 #define I2C_BUS_MS_TO_WAIT CONFIG_I2C_MS_TO_WAIT
 #define I2C_BUS_TICKS_TO_WAIT (I2C_BUS_MS_TO_WAIT/portTICK_PERIOD_MS)
 #define I2C_BUS_MUTEX_TICKS_TO_WAIT (I2C_BUS_MS_TO_WAIT/portTICK_PERIOD_MS)
+#define I2C_BUS_MAX_CLK_SPEED (1000000)                                                                 /*!< esp_driver_i2c limit; above 400kHz depends on the wiring */
+#define I2C_BUS_STACK_BUF_LEN (32)                                                                      /*!< Writes up to this size (address included) are assembled on the stack */
+#define I2C_BUS_ASYNC_MERGE_MAX (8)                                                                     /*!< Most stream segments coalesced into one transfer */
+#define I2C_BUS_ASYNC_MERGE_MAX_BYTES (256)                                                             /*!< Largest coalesced payload, so other devices wait a few ms at most */
+#define I2C_BUS_ASYNC_IDLE_BIT (1 << 0)                                                                 /*!< Set in s_async.events while no batch is pending */
+
+#if CONFIG_I2C_BUS_REMOVE_NULL_MEM_ADDR
+#define I2C_BUS_SENDS_MEM_ADDR(addr) (true)
+#else
+#define I2C_BUS_SENDS_MEM_ADDR(addr) ((addr) != NULL_I2C_MEM_ADDR)
+#endif
 
 typedef struct {
     i2c_master_bus_config_t bus_config;                                                                 /*!< I2C master bus specific configurations */
@@ -36,6 +53,9 @@ typedef struct {
     i2c_config_t conf_activate;                                                                         /*!< I2C active configuration */
     SemaphoreHandle_t mutex;                                                                            /*!< mutex to achieve thread-safe */
     int32_t ref_counter;                                                                                /*!< reference count */
+#if CONFIG_I2C_BUS_DEVICE_STATS
+    uint32_t last_scl_speed_hz;                                                                         /*!< Clock of the last transfer, to count switches between devices */
+#endif
 } i2c_bus_t;
 
 typedef struct {
@@ -43,9 +63,27 @@ typedef struct {
     i2c_master_dev_handle_t dev_handle;                                                                 /*!< I2C master bus device handle */
     i2c_device_config_t conf;                                                                           /*!< I2C active configuration */
     i2c_bus_t *i2c_bus;                                                                                 /*!< I2C bus */
+#if CONFIG_I2C_BUS_DEVICE_STATS
+    i2c_bus_device_stats_t stats;                                                                       /*!< Transfer statistics, updated with the bus mutex held */
+#endif
 } i2c_bus_device_t;
 
+typedef struct {
+    const i2c_bus_segment_t *segments;                                                                  /*!< Caller-owned, valid until cb */
+    size_t count;                                                                                       /*!< Number of segments */
+    i2c_bus_batch_cb_t cb;                                                                              /*!< Completion callback, may be NULL */
+    void *user_ctx;                                                                                     /*!< Passed to cb */
+} i2c_bus_batch_t;
+
+typedef struct {
+    QueueHandle_t queue;                                                                                /*!< Submitted batches */
+    SemaphoreHandle_t lock;                                                                             /*!< Guards pending */
+    EventGroupHandle_t events;                                                                          /*!< I2C_BUS_ASYNC_IDLE_BIT while nothing is pending */
+    uint32_t pending;                                                                                   /*!< Batches submitted and not yet finished */
+} i2c_bus_async_t;
+
 static const char *TAG = "i2c_bus";
+static i2c_bus_async_t s_async;
 
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
 static i2c_bus_t s_i2c_bus[I2C_NUM_SW_MAX];                                                             /*!< If software I2C is enabled, additional space is required to store the port. */
@@ -68,6 +106,12 @@ static i2c_bus_t s_i2c_bus[I2C_NUM_MAX];
         return (ret); \
     }
 
+#if CONFIG_I2C_BUS_DEVICE_STATS
+#define I2C_BUS_STATS_NOW() esp_timer_get_time()
+#else
+#define I2C_BUS_STATS_NOW() ((int64_t)0)
+#endif
+
 #define I2C_BUS_MUTEX_TAKE(mutex, ret) if (!xSemaphoreTake(mutex, I2C_BUS_MUTEX_TICKS_TO_WAIT)) { \
         ESP_LOGE(TAG, "i2c_bus take mutex timeout, max wait = %"PRIu32"ms", I2C_BUS_MUTEX_TICKS_TO_WAIT); \
         return (ret); \
@@ -87,6 +131,9 @@ static esp_err_t i2c_driver_reinit(i2c_port_t port, const i2c_config_t *conf);
 static esp_err_t i2c_driver_deinit(i2c_port_t port);
 static esp_err_t i2c_bus_write_reg8(i2c_bus_device_handle_t dev_handle, uint8_t mem_address, size_t data_len, const uint8_t *data);
 static esp_err_t i2c_bus_read_reg8(i2c_bus_device_handle_t dev_handle, uint8_t mem_address, size_t data_len, uint8_t *data);
+static esp_err_t i2c_bus_transmit_with_addr(i2c_bus_device_t *i2c_device, const uint8_t *addr, size_t addr_len, size_t data_len, const uint8_t *data);
+static void i2c_bus_stats_record(i2c_bus_device_t *i2c_device, int64_t requested_us, int64_t acquired_us, size_t bytes, esp_err_t ret);
+static void i2c_bus_async_task(void *arg);
 inline static bool i2c_config_compare(i2c_port_t port, const i2c_config_t *conf);
 /**************************************** Public Functions (Application level)*********************************************/
 
@@ -180,7 +227,10 @@ uint8_t i2c_bus_get_created_device_num(i2c_bus_handle_t bus_handle)
 i2c_bus_device_handle_t i2c_bus_device_create(i2c_bus_handle_t bus_handle, uint8_t dev_addr, uint32_t clk_speed)
 {
     I2C_BUS_CHECK(bus_handle != NULL, "Null Bus Handle", NULL);
-    I2C_BUS_CHECK(clk_speed <= 400000, "clk_speed must <= 400000", NULL);
+    I2C_BUS_CHECK(clk_speed <= I2C_BUS_MAX_CLK_SPEED, "clk_speed must <= 1000000", NULL);
+    if (clk_speed > 400000) {
+        ESP_LOGW(TAG, "device 0x%02x at %"PRIu32"Hz, above fast mode: check the pull-ups", dev_addr, clk_speed);
+    }
     i2c_bus_t *i2c_bus = (i2c_bus_t *)bus_handle;
     I2C_BUS_INIT_CHECK(i2c_bus->is_init, NULL);
     i2c_bus_device_t *i2c_device = calloc(1, sizeof(i2c_bus_device_t));
@@ -266,6 +316,35 @@ uint8_t i2c_bus_device_get_address(i2c_bus_device_handle_t dev_handle)
     return i2c_device->device_config.device_address;
 }
 
+esp_err_t i2c_bus_device_get_stats(i2c_bus_device_handle_t dev_handle, i2c_bus_device_stats_t *stats)
+{
+    I2C_BUS_CHECK(dev_handle != NULL, "device handle error", ESP_ERR_INVALID_ARG);
+    I2C_BUS_CHECK(stats != NULL, "stats pointer error", ESP_ERR_INVALID_ARG);
+#if CONFIG_I2C_BUS_DEVICE_STATS
+    i2c_bus_device_t *i2c_device = (i2c_bus_device_t *)dev_handle;
+    I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    *stats = i2c_device->stats;
+    I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t i2c_bus_device_reset_stats(i2c_bus_device_handle_t dev_handle)
+{
+    I2C_BUS_CHECK(dev_handle != NULL, "device handle error", ESP_ERR_INVALID_ARG);
+#if CONFIG_I2C_BUS_DEVICE_STATS
+    i2c_bus_device_t *i2c_device = (i2c_bus_device_t *)dev_handle;
+    I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    memset(&i2c_device->stats, 0, sizeof(i2c_device->stats));
+    I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t i2c_bus_read_bytes(i2c_bus_device_handle_t dev_handle, uint8_t mem_address, size_t data_len, uint8_t *data)
 {
     return i2c_bus_read_reg8(dev_handle, mem_address, data_len, data);
@@ -349,7 +428,9 @@ static esp_err_t i2c_bus_read_reg8(i2c_bus_device_handle_t dev_handle, uint8_t m
     I2C_BUS_CHECK(data != NULL, "data pointer error", ESP_ERR_INVALID_ARG);
     i2c_bus_device_t *i2c_device = (i2c_bus_device_t *)dev_handle;
     I2C_BUS_INIT_CHECK(i2c_device->i2c_bus->is_init, ESP_ERR_INVALID_STATE);
+    int64_t requested_us = I2C_BUS_STATS_NOW();
     I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    int64_t acquired_us = I2C_BUS_STATS_NOW();
     esp_err_t ret = ESP_FAIL;
 
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
@@ -371,6 +452,7 @@ static esp_err_t i2c_bus_read_reg8(i2c_bus_device_handle_t dev_handle, uint8_t m
         }
 #endif
     }
+    i2c_bus_stats_record(i2c_device, requested_us, acquired_us, 1 + data_len, ret);
     I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
     return ret;
 }
@@ -385,7 +467,9 @@ esp_err_t i2c_bus_read_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_ad
     uint8_t memAddress8[2];
     memAddress8[0] = (uint8_t)((mem_address >> 8) & 0x00FF);
     memAddress8[1] = (uint8_t)(mem_address & 0x00FF);
+    int64_t requested_us = I2C_BUS_STATS_NOW();
     I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    int64_t acquired_us = I2C_BUS_STATS_NOW();
 
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
     // Need to distinguish between hardware I2C and software I2C via port
@@ -406,6 +490,7 @@ esp_err_t i2c_bus_read_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_ad
         }
 #endif
     }
+    i2c_bus_stats_record(i2c_device, requested_us, acquired_us, 2 + data_len, ret);
     I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
     return ret;
 }
@@ -416,7 +501,9 @@ static esp_err_t i2c_bus_write_reg8(i2c_bus_device_handle_t dev_handle, uint8_t
     I2C_BUS_CHECK(data != NULL, "data pointer error", ESP_ERR_INVALID_ARG);
     i2c_bus_device_t *i2c_device = (i2c_bus_device_t *)dev_handle;
     I2C_BUS_INIT_CHECK(i2c_device->i2c_bus->is_init, ESP_ERR_INVALID_STATE);
+    int64_t requested_us = I2C_BUS_STATS_NOW();
     I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    int64_t acquired_us = I2C_BUS_STATS_NOW();
     esp_err_t ret = ESP_FAIL;
 
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
@@ -430,18 +517,7 @@ static esp_err_t i2c_bus_write_reg8(i2c_bus_device_handle_t dev_handle, uint8_t
 #if !CONFIG_I2C_BUS_REMOVE_NULL_MEM_ADDR
         if (mem_address != NULL_I2C_MEM_ADDR) {
 #endif
-            uint8_t *data_addr = malloc(data_len + 1);
-            if (data_addr == NULL) {
-                ESP_LOGE(TAG, "data_addr memory alloc fail");
-                I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
-                return ESP_ERR_NO_MEM;                                                                      /*!< If the memory request fails, unlock it immediately and return an error. */
-            }
-            data_addr[0] = mem_address;
-            for (int i = 0; i < data_len; i++) {
-                data_addr[i + 1] = data[i];
-            }
-            ret = i2c_master_transmit(i2c_device->dev_handle, data_addr, data_len + 1, I2C_BUS_TICKS_TO_WAIT);
-            free(data_addr);
+            ret = i2c_bus_transmit_with_addr(i2c_device, &mem_address, 1, data_len, data);
 #if !CONFIG_I2C_BUS_REMOVE_NULL_MEM_ADDR
         } else {
             ESP_LOGD(TAG, "register address 0x%X is skipped and will not be sent", NULL_I2C_MEM_ADDR);
@@ -449,6 +525,7 @@ static esp_err_t i2c_bus_write_reg8(i2c_bus_device_handle_t dev_handle, uint8_t
         }
 #endif
     }
+    i2c_bus_stats_record(i2c_device, requested_us, acquired_us, 1 + data_len, ret);
     I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
     return ret;
 }
@@ -462,7 +539,9 @@ esp_err_t i2c_bus_write_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_a
     uint8_t memAddress8[2];
     memAddress8[0] = (uint8_t)((mem_address >> 8) & 0x00FF);
     memAddress8[1] = (uint8_t)(mem_address & 0x00FF);
+    int64_t requested_us = I2C_BUS_STATS_NOW();
     I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+    int64_t acquired_us = I2C_BUS_STATS_NOW();
     esp_err_t ret = ESP_FAIL;
 
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
@@ -475,19 +554,7 @@ esp_err_t i2c_bus_write_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_a
 #if !CONFIG_I2C_BUS_REMOVE_NULL_MEM_ADDR
         if (mem_address != NULL_I2C_MEM_16BIT_ADDR) {
 #endif
-            uint8_t *data_addr = malloc(data_len + 2);
-            if (data_addr == NULL) {
-                ESP_LOGE(TAG, "data_addr memory alloc fail");
-                I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
-                return ESP_ERR_NO_MEM;                                                                      /*!< If the memory request fails, unlock it immediately and return an error. */
-            }
-            data_addr[0] = memAddress8[0];
-            data_addr[1] = memAddress8[1];
-            for (int i = 0; i < data_len; i++) {
-                data_addr[i + 2] = data[i];
-            }
-            ret = i2c_master_transmit(i2c_device->dev_handle, data_addr, data_len + 2, I2C_BUS_TICKS_TO_WAIT);
-            free(data_addr);
+            ret = i2c_bus_transmit_with_addr(i2c_device, memAddress8, 2, data_len, data);
 #if !CONFIG_I2C_BUS_REMOVE_NULL_MEM_ADDR
         } else {
             ESP_LOGD(TAG, "register address 0x%X is skipped and will not be sent", NULL_I2C_MEM_16BIT_ADDR);
@@ -495,12 +562,242 @@ esp_err_t i2c_bus_write_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_a
         }
 #endif
     }
+    i2c_bus_stats_record(i2c_device, requested_us, acquired_us, 2 + data_len, ret);
     I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
     return ret;
 }
 
+/**************************************** Public Functions (Asynchronous)*********************************************/
+
+esp_err_t i2c_bus_async_init(void)
+{
+    if (s_async.queue != NULL) {
+        return ESP_OK;
+    }
+    s_async.lock = xSemaphoreCreateMutex();
+    s_async.events = xEventGroupCreate();
+    s_async.queue = xQueueCreate(CONFIG_I2C_BUS_ASYNC_QUEUE_LEN, sizeof(i2c_bus_batch_t));
+    I2C_BUS_CHECK_GOTO(s_async.lock != NULL && s_async.events != NULL && s_async.queue != NULL, "async create failed", err);
+    xEventGroupSetBits(s_async.events, I2C_BUS_ASYNC_IDLE_BIT);
+    I2C_BUS_CHECK_GOTO(xTaskCreate(i2c_bus_async_task, "i2c_bus", CONFIG_I2C_BUS_ASYNC_TASK_STACK, NULL,
+                                   CONFIG_I2C_BUS_ASYNC_TASK_PRIORITY, NULL) == pdPASS, "async task create failed", err);
+    return ESP_OK;
+
+err:
+    if (s_async.queue != NULL) {
+        vQueueDelete(s_async.queue);
+        s_async.queue = NULL;
+    }
+    if (s_async.events != NULL) {
+        vEventGroupDelete(s_async.events);
+        s_async.events = NULL;
+    }
+    if (s_async.lock != NULL) {
+        vSemaphoreDelete(s_async.lock);
+        s_async.lock = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+/* pending only reaches 0, and the idle bit is only set, with the lock held, so a submit cannot slip between the two. */
+static void i2c_bus_async_pending_add(int delta)
+{
+    xSemaphoreTake(s_async.lock, portMAX_DELAY);
+    s_async.pending += delta;
+    if (s_async.pending == 0) {
+        xEventGroupSetBits(s_async.events, I2C_BUS_ASYNC_IDLE_BIT);
+    } else {
+        xEventGroupClearBits(s_async.events, I2C_BUS_ASYNC_IDLE_BIT);
+    }
+    xSemaphoreGive(s_async.lock);
+}
+
+esp_err_t i2c_bus_submit(const i2c_bus_segment_t *segments, size_t count, i2c_bus_batch_cb_t cb, void *user_ctx)
+{
+    I2C_BUS_CHECK(segments != NULL && count > 0, "empty batch", ESP_ERR_INVALID_ARG);
+    I2C_BUS_CHECK(s_async.queue != NULL, "i2c_bus_async_init() not called", ESP_ERR_INVALID_STATE);
+    I2C_BUS_CHECK(segments[0].dev_handle != NULL, "device handle error", ESP_ERR_INVALID_ARG);
+    i2c_bus_t *i2c_bus = ((i2c_bus_device_t *)segments[0].dev_handle)->i2c_bus;
+    I2C_BUS_INIT_CHECK(i2c_bus->is_init, ESP_ERR_INVALID_STATE);
+#if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
+    I2C_BUS_CHECK(i2c_bus->bus_config.i2c_port < I2C_NUM_MAX, "software bus not supported", ESP_ERR_NOT_SUPPORTED);
+#endif
+    for (size_t i = 0; i < count; i++) {
+        const i2c_bus_segment_t *seg = &segments[i];
+        I2C_BUS_CHECK(seg->dev_handle != NULL && ((i2c_bus_device_t *)seg->dev_handle)->i2c_bus == i2c_bus,
+                      "segments must share one bus", ESP_ERR_INVALID_ARG);
+        I2C_BUS_CHECK((seg->flags & I2C_BUS_SEGMENT_READ) ? seg->read_buf != NULL : seg->write_buf != NULL,
+                      "data pointer error", ESP_ERR_INVALID_ARG);
+    }
+
+    i2c_bus_batch_t batch = {
+        .segments = segments,
+        .count = count,
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    i2c_bus_async_pending_add(1);
+    if (xQueueSend(s_async.queue, &batch, I2C_BUS_TICKS_TO_WAIT) != pdTRUE) {
+        i2c_bus_async_pending_add(-1);
+        ESP_LOGE(TAG, "i2c_bus async queue full");
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_async_wait_idle(uint32_t timeout_ms)
+{
+    I2C_BUS_CHECK(s_async.queue != NULL, "i2c_bus_async_init() not called", ESP_ERR_INVALID_STATE);
+    EventBits_t bits = xEventGroupWaitBits(s_async.events, I2C_BUS_ASYNC_IDLE_BIT, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & I2C_BUS_ASYNC_IDLE_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
 /**************************************** Private Functions*********************************************/
 
+/* Number of segments from seg[0] on that can go out as one transfer: a run of stream writes to one device
+ * with the same control byte. */
+static size_t i2c_bus_async_run_length(const i2c_bus_segment_t *seg, size_t count)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+    if ((seg[0].flags & (I2C_BUS_SEGMENT_READ | I2C_BUS_SEGMENT_STREAM)) != I2C_BUS_SEGMENT_STREAM ||
+            !I2C_BUS_SENDS_MEM_ADDR(seg[0].mem_address)) {
+        return 1;
+    }
+    size_t run = 1;
+    size_t bytes = seg[0].data_len;
+    while (run < count && run < I2C_BUS_ASYNC_MERGE_MAX &&
+            seg[run].dev_handle == seg[0].dev_handle &&
+            seg[run].flags == seg[0].flags &&
+            seg[run].mem_address == seg[0].mem_address &&
+            bytes + seg[run].data_len <= I2C_BUS_ASYNC_MERGE_MAX_BYTES) {
+        bytes += seg[run].data_len;
+        run++;
+    }
+    return run;
+#else
+    return 1;
+#endif
+}
+
+/* Sends seg[0..run) as one transfer. Call with the bus mutex held. */
+static esp_err_t i2c_bus_async_transfer(i2c_bus_device_t *i2c_device, const i2c_bus_segment_t *seg, size_t run, size_t *bytes)
+{
+    bool sends_addr = I2C_BUS_SENDS_MEM_ADDR(seg[0].mem_address);
+    *bytes = sends_addr ? 1 : 0;
+    for (size_t i = 0; i < run; i++) {
+        *bytes += seg[i].data_len;
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+    if (run > 1) {
+        i2c_master_transmit_multi_buffer_info_t buffers[I2C_BUS_ASYNC_MERGE_MAX + 1];
+        buffers[0].write_buffer = (uint8_t *)&seg[0].mem_address;
+        buffers[0].buffer_size = 1;
+        for (size_t i = 0; i < run; i++) {
+            buffers[i + 1].write_buffer = (uint8_t *)seg[i].write_buf;
+            buffers[i + 1].buffer_size = seg[i].data_len;
+        }
+        return i2c_master_multi_buffer_transmit(i2c_device->dev_handle, buffers, run + 1, I2C_BUS_TICKS_TO_WAIT);
+    }
+#endif
+    if (seg->flags & I2C_BUS_SEGMENT_READ) {
+        if (sends_addr) {
+            return i2c_master_transmit_receive(i2c_device->dev_handle, &seg->mem_address, 1, seg->read_buf, seg->data_len, I2C_BUS_TICKS_TO_WAIT);
+        }
+        return i2c_master_receive(i2c_device->dev_handle, seg->read_buf, seg->data_len, I2C_BUS_TICKS_TO_WAIT);
+    }
+    if (sends_addr) {
+        return i2c_bus_transmit_with_addr(i2c_device, &seg->mem_address, 1, seg->data_len, seg->write_buf);
+    }
+    return i2c_master_transmit(i2c_device->dev_handle, seg->write_buf, seg->data_len, I2C_BUS_TICKS_TO_WAIT);
+}
+
+static esp_err_t i2c_bus_async_run(const i2c_bus_batch_t *batch)
+{
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < batch->count && ret == ESP_OK;) {
+        const i2c_bus_segment_t *seg = &batch->segments[i];
+        i2c_bus_device_t *i2c_device = (i2c_bus_device_t *)seg->dev_handle;
+        size_t run = i2c_bus_async_run_length(seg, batch->count - i);
+        size_t bytes = 0;
+        int64_t requested_us = I2C_BUS_STATS_NOW();
+        I2C_BUS_MUTEX_TAKE(i2c_device->i2c_bus->mutex, ESP_ERR_TIMEOUT);
+        int64_t acquired_us = I2C_BUS_STATS_NOW();
+        ret = i2c_bus_async_transfer(i2c_device, seg, run, &bytes);
+        i2c_bus_stats_record(i2c_device, requested_us, acquired_us, bytes, ret);
+        I2C_BUS_MUTEX_GIVE(i2c_device->i2c_bus->mutex, ESP_FAIL);
+        i += run;
+    }
+    return ret;
+}
+
+static void i2c_bus_async_task(void *arg)
+{
+    i2c_bus_batch_t batch;
+    while (true) {
+        if (xQueueReceive(s_async.queue, &batch, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        esp_err_t ret = i2c_bus_async_run(&batch);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "async batch failed: %s", esp_err_to_name(ret));
+        }
+        if (batch.cb != NULL) {
+            batch.cb(ret, batch.user_ctx);
+        }
+        i2c_bus_async_pending_add(-1);
+    }
+}
+
+/* Sends addr followed by data as one write. Short writes are assembled on the stack; longer ones go out as
+ * two buffers, so a full SSD1306 page or frame is neither allocated nor copied. Call with the bus mutex held. */
+static esp_err_t i2c_bus_transmit_with_addr(i2c_bus_device_t *i2c_device, const uint8_t *addr, size_t addr_len, size_t data_len, const uint8_t *data)
+{
+    if (addr_len + data_len <= I2C_BUS_STACK_BUF_LEN) {
+        uint8_t buf[I2C_BUS_STACK_BUF_LEN];
+        memcpy(buf, addr, addr_len);
+        memcpy(buf + addr_len, data, data_len);
+        return i2c_master_transmit(i2c_device->dev_handle, buf, addr_len + data_len, I2C_BUS_TICKS_TO_WAIT);
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+    i2c_master_transmit_multi_buffer_info_t buffers[2] = {
+        { .write_buffer = (uint8_t *)addr, .buffer_size = addr_len },
+        { .write_buffer = (uint8_t *)data, .buffer_size = data_len },
+    };
+    return i2c_master_multi_buffer_transmit(i2c_device->dev_handle, buffers, 2, I2C_BUS_TICKS_TO_WAIT);
+#else
+    uint8_t *buf = malloc(addr_len + data_len);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "write buffer alloc fail");
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(buf, addr, addr_len);
+    memcpy(buf + addr_len, data, data_len);
+    esp_err_t ret = i2c_master_transmit(i2c_device->dev_handle, buf, addr_len + data_len, I2C_BUS_TICKS_TO_WAIT);
+    free(buf);
+    return ret;
+#endif
+}
+
+/* Call with the bus mutex held. */
+static void i2c_bus_stats_record(i2c_bus_device_t *i2c_device, int64_t requested_us, int64_t acquired_us, size_t bytes, esp_err_t ret)
+{
+#if CONFIG_I2C_BUS_DEVICE_STATS
+    i2c_bus_device_stats_t *stats = &i2c_device->stats;
+    i2c_bus_t *i2c_bus = i2c_device->i2c_bus;
+    stats->transactions++;
+    stats->bytes += bytes;
+    if (ret != ESP_OK) {
+        stats->errors++;
+    }
+    if (i2c_bus->last_scl_speed_hz != 0 && i2c_bus->last_scl_speed_hz != i2c_device->device_config.scl_speed_hz) {
+        stats->clk_switches++;
+    }
+    i2c_bus->last_scl_speed_hz = i2c_device->device_config.scl_speed_hz;
+    stats->wait_us += acquired_us - requested_us;
+    stats->bus_us += esp_timer_get_time() - acquired_us;
+#endif
+}
+
 static esp_err_t i2c_driver_reinit(i2c_port_t port, const i2c_config_t *conf)
 {
 #if CONFIG_I2C_BUS_SUPPORT_SOFTWARE
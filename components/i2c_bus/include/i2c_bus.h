@@ -75,6 +75,41 @@ typedef struct {
 typedef void *i2c_cmd_handle_t;         /*!< I2C command handle  */
 #endif
 
+/**
+ * @brief Transfer statistics of one I2C device, counted since it was created or last reset
+ */
+typedef struct {
+    uint32_t transactions;              /*!< Completed transfers, successful or not */
+    uint32_t errors;                    /*!< Transfers that did not return ESP_OK */
+    uint32_t bytes;                     /*!< Bytes on the wire, register address included */
+    uint32_t clk_switches;              /*!< Transfers that followed a device with a different clock */
+    uint64_t bus_us;                    /*!< Time spent in transfers, bus mutex held */
+    uint64_t wait_us;                   /*!< Time spent waiting for the bus mutex */
+} i2c_bus_device_stats_t;
+
+#define I2C_BUS_SEGMENT_READ    (1 << 0)    /*!< Read data_len bytes into read_buf instead of writing write_buf */
+#define I2C_BUS_SEGMENT_STREAM  (1 << 1)    /*!< mem_address is a control byte that any number of data bytes may follow (e.g. SSD1306 0x00/0x40), so adjacent stream writes with the same one can be sent as one transfer */
+
+/**
+ * @brief One transfer of an asynchronous batch
+ */
+typedef struct {
+    i2c_bus_device_handle_t dev_handle; /*!< Target device; all segments of a batch must be on the same bus */
+    uint8_t mem_address;                /*!< 8-bit register or control byte, NULL_I2C_MEM_ADDR if none */
+    uint8_t flags;                      /*!< Bitwise of I2C_BUS_SEGMENT_* */
+    size_t data_len;                    /*!< Bytes to write or read */
+    const uint8_t *write_buf;           /*!< Data to write */
+    uint8_t *read_buf;                  /*!< Destination of a read */
+} i2c_bus_segment_t;
+
+/**
+ * @brief Called from the bus task once a batch has finished or failed
+ *
+ * @param ret ESP_OK, or the error of the first segment that failed; later segments are not sent
+ * @param user_ctx As passed to i2c_bus_submit()
+ */
+typedef void (*i2c_bus_batch_cb_t)(esp_err_t ret, void *user_ctx);
+
 /**************************************** Public Functions (Application level)*********************************************/
 
 /**
@@ -145,6 +180,7 @@ uint8_t i2c_bus_get_created_device_num(i2c_bus_handle_t bus_handle);
  * @param bus_handle Point to the I2C bus handle
  * @param dev_addr i2c device address
  * @param clk_speed device specified clock frequency the i2c_bus will switch to during each transfer. 0 if use current bus speed.
+ *        With esp_driver_i2c the clock is kept per device handle and up to 1MHz is accepted; above 400kHz it depends on the pull-ups and bus capacitance.
  * @return i2c_bus_device_handle_t return a device handle if created successfully, return NULL if failed.
  */
 i2c_bus_device_handle_t i2c_bus_device_create(i2c_bus_handle_t bus_handle, uint8_t dev_addr, uint32_t clk_speed);
@@ -167,6 +203,29 @@ esp_err_t i2c_bus_device_delete(i2c_bus_device_handle_t *p_dev_handle);
  */
 uint8_t i2c_bus_device_get_address(i2c_bus_device_handle_t dev_handle);
 
+/**
+ * @brief Get the transfer statistics of a device
+ *
+ * @param dev_handle I2C device handle
+ * @param stats Filled with a snapshot of the statistics
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid argument
+ *     - ESP_ERR_NOT_SUPPORTED Statistics are disabled or not available with this driver
+ */
+esp_err_t i2c_bus_device_get_stats(i2c_bus_device_handle_t dev_handle, i2c_bus_device_stats_t *stats);
+
+/**
+ * @brief Clear the transfer statistics of a device
+ *
+ * @param dev_handle I2C device handle
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid argument
+ *     - ESP_ERR_NOT_SUPPORTED Statistics are disabled or not available with this driver
+ */
+esp_err_t i2c_bus_device_reset_stats(i2c_bus_device_handle_t dev_handle);
+
 /**
  * @brief Read single byte from i2c device with 8-bit internal register/memory address
  *
@@ -351,6 +410,50 @@ esp_err_t i2c_bus_write_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_a
  */
 esp_err_t i2c_bus_read_reg16(i2c_bus_device_handle_t dev_handle, uint16_t mem_address, size_t data_len, uint8_t *data);
 
+/**************************************** Public Functions (Asynchronous)*********************************************/
+
+/**
+ * @brief Start the bus task that runs submitted batches. Safe to call again once it is running.
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM Could not create the task or its queue
+ *     - ESP_ERR_NOT_SUPPORTED Not available with this driver
+ */
+esp_err_t i2c_bus_async_init(void);
+
+/**
+ * @brief Queue a batch of transfers and return without waiting for them
+ *
+ * The bus task runs the segments in order, taking the bus mutex for each transfer, so synchronous
+ * callers for other devices can run in between. Adjacent I2C_BUS_SEGMENT_STREAM writes to the same
+ * device and control byte are coalesced into one transfer. Synchronous calls for a device with a
+ * batch outstanding are not ordered against it; wait for the callback or i2c_bus_async_wait_idle() first.
+ *
+ * @param segments Segments to run. The array and the buffers it points to must stay valid until the callback.
+ * @param count Number of segments
+ * @param cb Called from the bus task when the batch is done, may be NULL
+ * @param user_ctx Passed to cb
+ * @return
+ *     - ESP_OK Queued
+ *     - ESP_ERR_INVALID_ARG Empty batch, missing buffer or segments on more than one bus
+ *     - ESP_ERR_INVALID_STATE i2c_bus_async_init() has not been called
+ *     - ESP_ERR_TIMEOUT Queue full
+ *     - ESP_ERR_NOT_SUPPORTED Not available with this driver or on a software bus
+ */
+esp_err_t i2c_bus_submit(const i2c_bus_segment_t *segments, size_t count, i2c_bus_batch_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Wait until every submitted batch has finished. Must not be called from a batch callback.
+ *
+ * @param timeout_ms Longest wait
+ * @return
+ *     - ESP_OK Queue empty
+ *     - ESP_ERR_TIMEOUT Batches still outstanding
+ *     - ESP_ERR_NOT_SUPPORTED Not available with this driver
+ */
+esp_err_t i2c_bus_async_wait_idle(uint32_t timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,89 @@
+#include "anomaly_detector.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+#define TAG "[ANOMALY]"
+
+static RTC_DATA_ATTR anomaly_state_t state;
+
+static bool update_pressure(uint32_t timestamp, float pressure) {
+    uint32_t dt = timestamp - state.prev_ts;
+    bool have_prev = state.prev_ts != 0 && timestamp > state.prev_ts && dt <= ANOMALY_MAX_GAP_SECONDS;
+    float prev = state.prev_pressure;
+    state.prev_ts = timestamp;
+    state.prev_pressure = pressure;
+    if (!have_prev) {
+        // Across a gap (or a clock restore) the tendency is unknown.
+        state.pressure_cusum = 0.0f;
+        return false;
+    }
+
+    float excess_fall = (prev - pressure) - ANOMALY_PRESSURE_DRIFT * (dt / 3600.0f);
+    state.pressure_cusum = fmaxf(0.0f, state.pressure_cusum + excess_fall);
+    if (state.pressure_cusum > ANOMALY_PRESSURE_LIMIT) {
+        ESP_LOGW(TAG, "Pressure falling: %.2f hPa beyond drift", state.pressure_cusum);
+        state.pressure_cusum = 0.0f;
+        return true;
+    }
+    return false;
+}
+
+static bool update_humidity(float humidity) {
+    if (state.humidity_samples == 0) {
+        state.humidity_mean = humidity;
+        state.humidity_var = 0.0f;
+        state.humidity_samples = 1;
+        return false;
+    }
+
+    float diff = humidity - state.humidity_mean;
+    float stddev = fmaxf(sqrtf(state.humidity_var), ANOMALY_HUMIDITY_MIN_STDDEV);
+    bool fired = state.humidity_samples >= ANOMALY_WARMUP_SAMPLES &&
+                 fabsf(diff) > ANOMALY_HUMIDITY_Z * stddev;
+
+    state.humidity_mean += ANOMALY_HUMIDITY_ALPHA * diff;
+    state.humidity_var = (1.0f - ANOMALY_HUMIDITY_ALPHA) *
+                         (state.humidity_var + ANOMALY_HUMIDITY_ALPHA * diff * diff);
+    if (state.humidity_samples < UINT16_MAX) {
+        state.humidity_samples++;
+    }
+
+    if (fired) {
+        ESP_LOGW(TAG, "Humidity jump: %.1f%% against %.1f +- %.1f",
+                 humidity, state.humidity_mean, stddev);
+    }
+    return fired;
+}
+
+void anomaly_reset(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+uint8_t anomaly_update(uint32_t timestamp, const t_bme280_s_val* value) {
+    uint8_t fired = 0;
+    if (update_pressure(timestamp, value->pressure)) {
+        fired |= ANOMALY_PRESSURE_DROP;
+    }
+    if (update_humidity(value->humidity)) {
+        fired |= ANOMALY_HUMIDITY_JUMP;
+    }
+
+    if (fired != 0) {
+        if (!anomaly_alert_active(timestamp)) {
+            state.alert_flags = 0;
+        }
+        state.alert_flags |= fired;
+        state.alert_until_ts = timestamp + ANOMALY_ALERT_HOLD_MINUTES * 60;
+    }
+    return fired;
+}
+
+bool anomaly_alert_active(uint32_t now) {
+    return state.alert_flags != 0 && now < state.alert_until_ts;
+}
+
+uint8_t anomaly_alert_flags(uint32_t now) {
+    return anomaly_alert_active(now) ? state.alert_flags : 0;
+}
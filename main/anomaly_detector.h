@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_structure.h"
+
+// Streaming detector for the weather changes worth an off-schedule forecast,
+// run on every reading (sub-hourly and hourly) with O(1) state in RTC memory:
+//   - pressure: one-sided CUSUM on the falling tendency, i.e. how far the
+//     pressure has dropped beyond ANOMALY_PRESSURE_DRIFT per hour;
+//   - humidity: EWMA z-score, for the sudden jumps that come with rain.
+// A firing raises an alert that holds for ANOMALY_ALERT_HOLD_MINUTES and is
+// extended while it keeps firing.
+
+#define ANOMALY_PRESSURE_DRIFT          0.5f    // hPa/h of fall tolerated
+#define ANOMALY_PRESSURE_LIMIT          1.5f    // hPa of excess fall to fire
+#define ANOMALY_MAX_GAP_SECONDS         (3 * 3600)
+#define ANOMALY_HUMIDITY_ALPHA          0.1f
+#define ANOMALY_HUMIDITY_MIN_STDDEV     1.0f    // %RH, keeps calm air quiet
+#define ANOMALY_HUMIDITY_Z              4.0f
+#define ANOMALY_WARMUP_SAMPLES          12
+#define ANOMALY_ALERT_HOLD_MINUTES      60
+// Sample wake interval while an alert holds; each of those wakes runs a
+// forecast and uplink.
+#define ANOMALY_ALERT_SAMPLE_MINUTES    5
+
+#define ANOMALY_PRESSURE_DROP           0x01
+#define ANOMALY_HUMIDITY_JUMP           0x02
+
+typedef struct {
+    uint32_t prev_ts;
+    float    prev_pressure;
+    float    pressure_cusum;
+    float    humidity_mean;
+    float    humidity_var;
+    uint16_t humidity_samples;
+    uint8_t  alert_flags;
+    uint32_t alert_until_ts;
+} anomaly_state_t;
+
+// Forgets all history (cold boot).
+void anomaly_reset(void);
+
+// Feeds one reading taken at `timestamp` (seconds). Returns the
+// ANOMALY_* flags that fired on it, 0 when calm.
+uint8_t anomaly_update(uint32_t timestamp, const t_bme280_s_val* value);
+
+bool anomaly_alert_active(uint32_t now);
+
+// ANOMALY_* flags of the alert holding at `now`, 0 if none.
+uint8_t anomaly_alert_flags(uint32_t now);
+
+#endif
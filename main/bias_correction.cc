@@ -0,0 +1,105 @@
+#include "bias_correction.h"
+#include "esp_attr.h"
+#include "packed_sample.h"
+#include <string.h>
+
+// Regressor centre per variable: the middle of the training range, so bias
+// and slope stay decoupled.
+static const float centre[3] = { 30.0f, 62.0f, 1007.6f };
+
+typedef struct {
+    float bias;
+    float slope;
+    float p00, p01, p11;                 // Covariance, symmetric
+    uint16_t updates;
+} t_rls_pair;
+
+typedef struct {
+    uint8_t next;
+    t_skill_forecast raw[SKILL_FORECASTS];
+    t_rls_pair pairs[SKILL_HORIZONS][3];
+} t_bias_state;
+
+static RTC_DATA_ATTR t_bias_state state;
+
+static void rls_update(t_rls_pair* r, float u, float error) {
+    // Regressor x = [1, u], target y = error.
+    float px0 = r->p00 + r->p01 * u;
+    float px1 = r->p01 + r->p11 * u;
+    float lambda = r->p00 + r->p11 < BIAS_MAX_TRACE ? BIAS_FORGETTING : 1.0f;
+    float denom = lambda + px0 + u * px1;
+    float k0 = px0 / denom;
+    float k1 = px1 / denom;
+
+    float residual = error - (r->bias + r->slope * u);
+    r->bias += k0 * residual;
+    r->slope += k1 * residual;
+
+    r->p00 = (r->p00 - k0 * px0) / lambda;
+    r->p01 = (r->p01 - k0 * px1) / lambda;
+    r->p11 = (r->p11 - k1 * px1) / lambda;
+
+    if (r->updates < UINT16_MAX) {
+        r->updates++;
+    }
+}
+
+static float rls_correct(const t_rls_pair* r, float forecast, float c) {
+    if (r->updates < BIAS_MIN_UPDATES) {
+        return forecast;
+    }
+    return forecast + r->bias + r->slope * (forecast - c);
+}
+
+void bias_correction_reset(void) {
+    memset(&state, 0, sizeof(state));
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        for (int v = 0; v < 3; v++) {
+            state.pairs[h][v].p00 = BIAS_PRIOR_BIAS;
+            state.pairs[h][v].p11 = BIAS_PRIOR_SLOPE;
+        }
+    }
+}
+
+void bias_correction_record(uint32_t issued_ts, const t_infered* forecast) {
+    t_skill_forecast* slot = &state.raw[state.next];
+    slot->issued_ts = issued_ts;
+    slot->scored = 0;
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        slot->predicted[h] = pack_sample(&forecast->predicted_data[h]);
+    }
+    state.next = (state.next + 1) % SKILL_FORECASTS;
+}
+
+void bias_correction_apply(t_infered* forecast) {
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        t_bme280_s_val* p = &forecast->predicted_data[h];
+        p->temperature = rls_correct(&state.pairs[h][0], p->temperature, centre[0]);
+        p->humidity = rls_correct(&state.pairs[h][1], p->humidity, centre[1]);
+        p->pressure = rls_correct(&state.pairs[h][2], p->pressure, centre[2]);
+    }
+}
+
+int bias_correction_observe(uint32_t timestamp, const t_bme280_s_val* observed) {
+    int updated = 0;
+    for (int i = 0; i < SKILL_FORECASTS; i++) {
+        t_skill_forecast* f = &state.raw[i];
+        int horizon = forecast_horizon(f->issued_ts, timestamp);
+        if (horizon == 0) {
+            continue;
+        }
+        uint8_t bit = (uint8_t)(1u << (horizon - 1));
+        if (f->scored & bit) {
+            continue;
+        }
+
+        t_bme280_s_val raw = unpack_sample(f->predicted[horizon - 1]);
+        t_rls_pair* pairs = state.pairs[horizon - 1];
+        rls_update(&pairs[0], raw.temperature - centre[0], observed->temperature - raw.temperature);
+        rls_update(&pairs[1], raw.humidity - centre[1], observed->humidity - raw.humidity);
+        rls_update(&pairs[2], raw.pressure - centre[2], observed->pressure - raw.pressure);
+        f->scored |= bit;
+        updated++;
+    }
+    return updated;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef BIAS_CORRECTION_H
+#define BIAS_CORRECTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_structure.h"
+#include "forecast_skill.h"
+
+// Per-station correction of the model output, learned on the device. For
+// every horizon and variable the forecast error is modelled as
+//     observed - forecast = bias + slope * (forecast - centre)
+// and (bias, slope) are fitted by recursive least squares with exponential
+// forgetting, one update per observation. State is 5 floats per pair, plus
+// the raw forecasts waiting to be scored, all in RTC memory.
+
+#define BIAS_FORGETTING         0.995f  // ~200 updates of memory per pair
+#define BIAS_PRIOR_BIAS         10.0f   // Initial variance of bias
+#define BIAS_PRIOR_SLOPE        1e-3f   // Initial variance of slope
+#define BIAS_MAX_TRACE          100.0f  // Stop forgetting past this, no windup
+#define BIAS_MIN_UPDATES        12      // Per pair, before it is applied
+
+// Forgets everything learned (cold boot).
+void bias_correction_reset(void);
+
+// Keeps the uncorrected `forecast`, issued at `issued_ts` (seconds), to learn
+// from once its steps are observed.
+void bias_correction_record(uint32_t issued_ts, const t_infered* forecast);
+
+// Corrects `forecast` in place with what has been learned so far.
+void bias_correction_apply(t_infered* forecast);
+
+// Updates every pair with a recorded step due at `timestamp`. Returns how
+// many horizons were updated.
+int bias_correction_observe(uint32_t timestamp, const t_bme280_s_val* observed);
+
+#endif
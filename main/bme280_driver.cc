@@ -8,6 +8,8 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "bme280.h"
 #include "i2c_bus.h"
 
@@ -17,11 +19,70 @@ static bme280_handle_t bme280 = NULL;
 
 #define TAG "[I2C]"
 
+typedef struct {
+    bme280_sensor_sampling temperature;
+    bme280_sensor_sampling pressure;
+    bme280_sensor_sampling humidity;
+    bme280_sensor_filter filter;
+} t_sensor_profile;
+
+// Indexed by sensor_profile_t.
+static const t_sensor_profile profiles[] = {
+    { BME280_SAMPLING_X1, BME280_SAMPLING_X1, BME280_SAMPLING_X1, BME280_FILTER_OFF },      // WEATHER
+    { BME280_SAMPLING_X2, BME280_SAMPLING_X16, BME280_SAMPLING_X1, BME280_FILTER_OFF },     // PRECISION
+    { BME280_SAMPLING_X16, BME280_SAMPLING_X16, BME280_SAMPLING_X16, BME280_FILTER_OFF },   // MAXIMUM
+};
+static_assert(sizeof(profiles) / sizeof(profiles[0]) == SENSOR_PROFILE_MAXIMUM + 1, "one entry per sensor_profile_t");
+
+// The BME280 stays powered through deep sleep and keeps its registers, so
+// after the first configuration only the calibration has to be restored.
+typedef struct {
+    bool valid;
+    uint8_t profile;
+    bme280_data_t calibration;
+} t_sensor_config;
+
+static RTC_DATA_ATTR t_sensor_config sensor_config;
+
 i2c_bus_handle_t get_i2c_bus_handle(void) {
     return bus_handler;
 }
 
+i2c_bus_device_handle_t get_sensor_i2c_device(void) {
+    return bme280 != NULL ? bme280_get_i2c_device(bme280) : NULL;
+}
+
+static esp_err_t configure_sensor(void) {
+    const t_sensor_profile* profile = &profiles[SENSOR_PROFILE];
+
+    if (sensor_config.valid && sensor_config.profile == SENSOR_PROFILE) {
+        bme280_restore_settings(bme280, &sensor_config.calibration, BME280_MODE_FORCED,
+                                profile->temperature, profile->pressure, profile->humidity,
+                                profile->filter, BME280_STANDBY_MS_0_5);
+        return ESP_OK;
+    }
+
+    sensor_config.valid = false;
+    if (bme280_default_init(bme280) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    if (bme280_set_sampling(bme280, BME280_MODE_FORCED, profile->temperature, profile->pressure,
+                            profile->humidity, profile->filter, BME280_STANDBY_MS_0_5) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    sensor_config.calibration = *bme280_get_calibration(bme280);
+    sensor_config.profile = SENSOR_PROFILE;
+    sensor_config.valid = true;
+    ESP_LOGI(TAG, "BME280 configured, profile %d, conversion %lu us",
+             SENSOR_PROFILE, (unsigned long)bme280_measurement_time_us(bme280));
+    return ESP_OK;
+}
+
 void initialize_i2c(){
+    // An alert escalates a sample wake to a full one, which initialises again.
+    if (bus_handler != NULL) {
+        return;
+    }
     ESP_LOGI(TAG, "OPENING I2C PROTOCOL");
     
     i2c_config_t i2c_conf;
@@ -32,22 +93,31 @@ void initialize_i2c(){
     i2c_conf.scl_io_num = GPIO_NUM_6;
     i2c_conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
     i2c_conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    i2c_conf.master.clk_speed = 100000;
+    i2c_conf.master.clk_speed = I2C_BUS_CLOCK_HZ;
 
     bus_handler = i2c_bus_create(I2C_NUM_0, &i2c_conf);
     if(bus_handler == NULL){
         ESP_LOGE(TAG, "Failed to init i2c\n");
     }
     bme280 = bme280_create(bus_handler, 0x76);
-    bme280_default_init(bme280);
+    if (configure_sensor() != ESP_OK) {
+        ESP_LOGE(TAG, "BME280 configuration failed");
+    }
 }
 
-void read_sensor(t_bme280_s_val* payload) {
+void read_sensor(t_bme280_s_val* payload, t_packed_sample* packed) {
     int retries  = 0;
     esp_err_t read_result = ESP_FAIL;
+    bme280_fixed_t fixed;
+    int64_t started = esp_timer_get_time();
     
+    // Trigger one forced conversion, sleep through it, then read all three
+    // values in one 8-byte burst.
     while(retries < 10){
-        read_result = bme280_read_humidity(bme280, &(payload->humidity));
+        read_result = bme280_take_forced_measurement(bme280);
+        if(read_result == ESP_OK) {
+            read_result = bme280_read_all_fixed(bme280, &fixed);
+        }
         if(read_result == ESP_OK) {
             break;
         }
@@ -60,9 +130,17 @@ void read_sensor(t_bme280_s_val* payload) {
         payload->humidity = -1.0f;
         payload->temperature = -1.0f;
         payload->pressure = -1.0f;
+        // Re-initialise next wake in case the sensor lost its settings.
+        sensor_config.valid = false;
         return;
     }
 
-    bme280_read_temperature(bme280, &(payload->temperature));
-    bme280_read_pressure(bme280, &(payload->pressure));
+    if (packed != NULL) {
+        *packed = pack_sample_fixed(fixed.temperature, fixed.pressure, fixed.humidity);
+    }
+    payload->temperature = fixed.temperature / 100.0f;
+    payload->humidity = fixed.humidity / 1024.0f;
+    payload->pressure = (fixed.pressure >> 8) / 100.0f;
+
+    ESP_LOGD(TAG, "Sensor read: %d attempt(s), %lld us", retries + 1, esp_timer_get_time() - started);
 }
\ No newline at end of file
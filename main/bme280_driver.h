@@ -1,13 +1,42 @@
 #ifndef READING_SENSOR_H_
 #define READING_SENSOR_H_
 #include "data_structure.h"
+#include "packed_sample.h"
 #include "i2c_bus.h"
 
+// Acquisition profiles. All run in forced mode: one conversion per
+// read_sensor(), with the sensor asleep in between.
+//   WEATHER    x1 T / x1 P / x1 H, filter off     ~9 ms, datasheet 3.5.1
+//   PRECISION  x2 T / x16 P / x1 H, filter off    ~46 ms
+//   MAXIMUM    x16 on all three, filter off       ~113 ms, the old setting
+typedef enum {
+    SENSOR_PROFILE_WEATHER = 0,
+    SENSOR_PROFILE_PRECISION,
+    SENSOR_PROFILE_MAXIMUM,
+} sensor_profile_t;
+
+#ifndef SENSOR_PROFILE
+#define SENSOR_PROFILE              SENSOR_PROFILE_WEATHER
+#endif
+
+// Bus clock, which the BME280 also runs at (it allows up to 3.4 MHz). The
+// display sets its own, see OLED_I2C_CLOCK_HZ. 400 kHz relies on the
+// breakout boards' pull-ups; the internal ones alone are too weak for it.
+#ifndef I2C_BUS_CLOCK_HZ
+#define I2C_BUS_CLOCK_HZ            400000
+#endif
+
 void initialize_i2c(void);
-void read_sensor(t_bme280_s_val* payload);
+// Fills `payload` for display and MQTT and, if not NULL, `packed` with the
+// same reading converted from the sensor's fixed point without any float
+// step. On failure all of `payload` is -1 and `packed` is left untouched.
+void read_sensor(t_bme280_s_val* payload, t_packed_sample* packed);
 
 // Get the shared I2C bus handle
 i2c_bus_handle_t get_i2c_bus_handle(void);
 
-#endif
+// The BME280's device on the bus, for i2c_bus_device_get_stats(). NULL
+// before initialize_i2c().
+i2c_bus_device_handle_t get_sensor_i2c_device(void);
 
+#endif
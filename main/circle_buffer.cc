@@ -7,19 +7,112 @@
 #include "freertos/task.h"
 #include "data_structure.h"
 #include "esp_log.h"
+#include "sensor_log.h"
+#include "packed_sample.h"
+#include <sys/time.h>
 
 #define USER_LED_PIN GPIO_NUM_21
 
 
-#define MAX_BUFFER 24
-
-int RTC_DATA_ATTR size;
-int RTC_DATA_ATTR buffer_index;
-static RTC_DATA_ATTR t_bme280_s_val sensor_buffer[24];
+static RTC_DATA_ATTR t_sensor_history history;
 
 RTC_DATA_ATTR bool data_valid_flag;
 int last_reset_code;
 
+// Set when the power-on restore had to bridge a long or unmeasured gap;
+// cleared in effect once kModelInputSteps live samples have replaced it.
+static RTC_DATA_ATTR bool restored_degraded;
+static RTC_DATA_ATTR int live_since_restore;
+// Newest restored timestamp, while the gap up to the first live sample is
+// still to be filled. 0 once it has been.
+static RTC_DATA_ATTR uint32_t restored_newest_ts;
+
+static uint32_t now_seconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)tv.tv_sec;
+}
+
+// Without a network time source the clock restarts at 0 after power loss.
+// Move it up to the newest logged sample so the log stays in time order; the
+// length of the outage itself is lost. Returns true if the clock was moved.
+static bool restore_clock_from_log() {
+    uint32_t newest = sensor_log_newest_timestamp();
+    if (now_seconds() < newest) {
+        struct timeval tv = { .tv_sec = (time_t)newest, .tv_usec = 0 };
+        settimeofday(&tv, NULL);
+        printf("SYSTEM: Clock restored from sensor log (%lu)\n", (unsigned long)newest);
+        return true;
+    }
+    return false;
+}
+
+// Whole hours missing between two samples taken `seconds` apart.
+static uint32_t missing_hours(uint32_t seconds) {
+    uint32_t hours = (seconds + 1800) / 3600;
+    return hours > 0 ? hours - 1 : 0;
+}
+
+// Fills `missing` hours between the newest sample in the ring and `next`.
+// Past one window the extra hours would drop out before the model saw them,
+// so long gaps are squeezed into kModelInputSteps.
+static void bridge_gap(uint32_t missing, t_packed_sample next) {
+    if (missing == 0 || history.size() == 0) {
+        return;
+    }
+    if (missing > RESTORE_MAX_INTERPOLATED_HOURS) {
+        restored_degraded = true;
+    }
+    if (missing > kModelInputSteps) {
+        missing = kModelInputSteps;
+    }
+    t_packed_sample from = history.latest(1).first.data[0];
+    for (uint32_t i = 1; i <= missing; i++) {
+        history.push(interpolate_sample(from, next, i, missing + 1));
+    }
+}
+
+// Refills the RTC history from the flash log after any reset but a deep sleep
+// wake, so a full window is available on the next wake instead of a day later.
+static void restore_history_from_log(bool clock_restored) {
+    uint32_t end_ts = sensor_log_newest_timestamp();
+    uint32_t span = HISTORY_HOURS * 3600;
+    uint32_t start_ts = end_ts >= span ? end_ts - span + 1 : 0;
+
+    sensor_log_cursor_t cursor;
+    if (end_ts == 0 || sensor_log_seek(&cursor, start_ts, end_ts) != ESP_OK) {
+        return;
+    }
+
+    int restored = 0;
+    uint32_t prev_ts = 0;
+    sensor_log_sample_t sample;
+    while (sensor_log_next(&cursor, &sample)) {
+        t_packed_sample packed = pack_sample(&sample.value);
+        if (restored > 0) {
+            bridge_gap(missing_hours(sample.timestamp - prev_ts), packed);
+        }
+        history.push(packed);
+        prev_ts = sample.timestamp;
+        restored++;
+    }
+    if (restored == 0) {
+        return;
+    }
+
+    live_since_restore = 0;
+    if (clock_restored) {
+        // The clock restarted from zero, so there's no telling how long the
+        // node was off.
+        restored_degraded = true;
+        restored_newest_ts = 0;
+    } else {
+        restored_newest_ts = end_ts;
+    }
+    printf("SYSTEM: Restored %d samples from sensor log (history %d)%s\n",
+           restored, history.size(), restored_degraded ? ", window degraded" : "");
+}
+
 void init_circular_buffer() {
     esp_reset_reason_t reason = esp_reset_reason();
     
@@ -31,17 +124,13 @@ void init_circular_buffer() {
     switch (reason) {
         case ESP_RST_POWERON:
             printf("SYSTEM: Power On Reset. Initializing Buffer...\n");
-            size = 0;
-            buffer_index = 0;
-            data_valid_flag = true;
-            
             gpio_set_level(USER_LED_PIN, 0);
             vTaskDelay(pdMS_TO_TICKS(100)); 
             gpio_set_level(USER_LED_PIN, 1); 
             break;
 
         case ESP_RST_DEEPSLEEP:
-            printf("SYSTEM: Wakeup from Deep Sleep. Buffer Preserved. Size: %d\n", size);
+            printf("SYSTEM: Wakeup from Deep Sleep. Buffer Preserved. Size: %d\n", history.size());
             gpio_set_level(USER_LED_PIN, 0); 
             vTaskDelay(pdMS_TO_TICKS(100));  
             gpio_set_level(USER_LED_PIN, 1); 
@@ -52,10 +141,6 @@ void init_circular_buffer() {
             gpio_set_level(USER_LED_PIN, 1); 
             vTaskDelay(pdMS_TO_TICKS(100)); 
             gpio_set_level(USER_LED_PIN, 0); 
-            
-            uint64_t brownout_sleep_us = 60ULL * 1000000ULL; // 1 minute
-            esp_sleep_enable_timer_wakeup(brownout_sleep_us);
-            esp_deep_sleep_start();
             break;
         }
 
@@ -86,27 +171,115 @@ void init_circular_buffer() {
             printf("SYSTEM: Unknown Reset Reason (%d)\n", reason);
             break;
     }
-}
 
+    // RTC memory is reloaded from the image on every reset but a deep sleep
+    // wake, so after a crash or brownout the ring is as empty as after power
+    // loss and is refilled from the log the same way.
+    bool cold = reason != ESP_RST_DEEPSLEEP;
+    if (cold) {
+        history.clear();
+        restored_degraded = false;
+        live_since_restore = 0;
+        restored_newest_ts = 0;
+        data_valid_flag = true;
+    }
 
-void push_data_into_stack(t_bme280_s_val data){
-    sensor_buffer[buffer_index] = data;
-    if(size < MAX_BUFFER){
-        size += 1;
-        printf("%d \n", size);
+    esp_err_t ret = sensor_log_init(!cold);
+    if (ret != ESP_OK) {
+        printf("WARNING: Sensor log unavailable (%s), keeping RTC history only\n", esp_err_to_name(ret));
+    } else if (cold) {
+        bool clock_restored = restore_clock_from_log();
+        restore_history_from_log(clock_restored);
+    }
+
+    // Give the supply a minute before Wi-Fi and the display draw current
+    // again. The history is already restored, so the wake after is warm.
+    if (reason == ESP_RST_BROWNOUT) {
+        uint64_t brownout_sleep_us = 60ULL * 1000000ULL; // 1 minute
+        esp_sleep_enable_timer_wakeup(brownout_sleep_us);
+        esp_deep_sleep_start();
     }
-    buffer_index = (buffer_index+1) % MAX_BUFFER;
 }
 
-void yield_data(t_bme280_s_val sensor_data[]) {
-    int j = buffer_index;
-    for (int i = 0; i < MAX_BUFFER; i++) {
-        sensor_data[i] = sensor_buffer[j];
-        j = (j + 1) % MAX_BUFFER;
+
+const t_sensor_history& sensor_history() {
+    return history;
+}
+
+bool window_degraded() {
+    return restored_degraded && live_since_restore < kModelInputSteps;
+}
+
+void push_data_into_stack(t_packed_sample packed){
+    t_bme280_s_val data = unpack_sample(packed);
+    if (restored_newest_ts != 0) {
+        bridge_gap(missing_hours(now_seconds() - restored_newest_ts), packed);
+        restored_newest_ts = 0;
+    }
+    if (live_since_restore < kModelInputSteps) {
+        live_since_restore++;
     }
+    history.push(packed);
+
+    esp_err_t ret = sensor_log_append(now_seconds(), &data);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        printf("WARNING: Sensor log append failed (%s)\n", esp_err_to_name(ret));
+    }
+}
+
+void yield_data(t_bme280_s_val sensor_data[kModelInputSteps]) {
+    yield_history(sensor_data, kModelInputSteps);
 }
 
+static int unpack_span(t_bme280_s_val* out, ring_span_t<t_packed_sample> span) {
+    for (int i = 0; i < span.size; i++) {
+        out[i] = unpack_sample(span.data[i]);
+    }
+    return span.size;
+}
 
+int yield_history(t_bme280_s_val sensor_data[], int hours) {
+    ring_window_t<t_packed_sample> window = history.latest(hours);
+    int count = unpack_span(sensor_data, window.first);
+    count += unpack_span(sensor_data + count, window.second);
+    return count;
+}
 
+t_feature_scaling make_feature_scaling(const t_bme280_s_val* min, const t_bme280_s_val* max) {
+    t_feature_scaling scaling;
+    float range[3] = {
+        max->temperature - min->temperature,
+        max->humidity - min->humidity,
+        max->pressure - min->pressure,
+    };
+    scaling.scale[0] = PACKED_TEMPERATURE_LSB / range[0];
+    scaling.scale[1] = PACKED_HUMIDITY_LSB / range[1];
+    scaling.scale[2] = PACKED_PRESSURE_LSB / range[2];
+    scaling.offset[0] = -min->temperature / range[0];
+    scaling.offset[1] = -min->humidity / range[1];
+    scaling.offset[2] = (PACKED_PRESSURE_BASE - min->pressure) / range[2];
+    return scaling;
+}
 
+static float scale_clamped(int32_t raw, float scale, float offset, int* clamped) {
+    float v = raw * scale + offset;
+    if (v < 0.0f) {
+        (*clamped)++;
+        return 0.0f;
+    }
+    if (v > 1.0f) {
+        (*clamped)++;
+        return 1.0f;
+    }
+    return v;
+}
 
+int scale_span(float* input, ring_span_t<t_packed_sample> span, const t_feature_scaling* scaling) {
+    int clamped = 0;
+    for (const t_packed_sample* packed = span.data; packed != span.data + span.size; packed++) {
+        *input++ = scale_clamped(packed->temperature, scaling->scale[0], scaling->offset[0], &clamped);
+        *input++ = scale_clamped(packed->humidity, scaling->scale[1], scaling->offset[1], &clamped);
+        *input++ = scale_clamped(packed->pressure, scaling->scale[2], scaling->offset[2], &clamped);
+    }
+    return clamped;
+}
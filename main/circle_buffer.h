@@ -3,15 +3,79 @@
 #ifndef CIRCLE_BUFFER_H
 #define CIRCLE_BUFFER_H
     #include "data_structure.h"
+    #include "packed_sample.h"
+    #include "ring_buffer.h"
+    #include "model_data.h"
+    #include <stdint.h>
 
 
-    extern int size;
-    extern int buffer_index;
+    // Hours of packed history kept in RTC memory (6 bytes per hour). The
+    // model window is the newest kModelInputSteps.
+    #define HISTORY_HOURS 168
+    #define SAMPLE_FEATURES 3
+
+    // After power loss the window is refilled from the flash sensor log. Gaps
+    // of up to this many hours are filled by linear interpolation; longer ones
+    // (or an outage of unknown length) mark the window degraded.
+    #define RESTORE_MAX_INTERPOLATED_HOURS 3
+
+    static_assert(kModelInputFeatures == SAMPLE_FEATURES,
+                  "model input features don't match t_packed_sample");
+    static_assert(kModelInputSteps <= HISTORY_HOURS,
+                  "model window is longer than the RTC history");
+
+    typedef RingBuffer<t_packed_sample, HISTORY_HOURS> t_sensor_history;
+
+    // Folds the fixed-point LSB and the min-max normalisation of each feature
+    // into one multiply-add on the packed value.
+    typedef struct {
+        float scale[SAMPLE_FEATURES];
+        float offset[SAMPLE_FEATURES];
+    } t_feature_scaling;
+
     extern int last_reset_code;
 
     // void preload_sensor_buffer();
     void init_circular_buffer();
-    void push_data_into_stack(t_bme280_s_val data);
-    void yield_data(t_bme280_s_val sensor_data[]);
+    void push_data_into_stack(t_packed_sample packed);
+    void yield_data(t_bme280_s_val sensor_data[kModelInputSteps]);
+
+    // Decodes the newest `hours` samples (at most HISTORY_HOURS), oldest
+    // first, and returns how many were written.
+    int yield_history(t_bme280_s_val sensor_data[], int hours);
+
+    const t_sensor_history& sensor_history();
+
+    // Samples held in RTC memory, up to HISTORY_HOURS.
+    inline int history_size() {
+        return sensor_history().size();
+    }
+
+    // True once a full model window has been collected.
+    inline bool window_ready() {
+        return sensor_history().has_window<kModelInputSteps>();
+    }
+
+    // True while the model window still holds samples restored across a long
+    // or unmeasured gap, i.e. until a full window of live samples has come in.
+    bool window_degraded();
+
+    t_feature_scaling make_feature_scaling(const t_bme280_s_val* min, const t_bme280_s_val* max);
+
+    // Writes one span of packed samples to `input` as [span.size][3] floats
+    // normalised to [0, 1]. Returns how many values had to be clamped.
+    int scale_span(float* input, ring_span_t<t_packed_sample> span, const t_feature_scaling* scaling);
+
+    // Decodes the newest WindowLen samples straight from the RTC ring into a
+    // [WindowLen][Features] float input tensor, normalised to [0, 1]. Returns
+    // how many values had to be clamped.
+    template <int WindowLen, int Features>
+    int yield_window_scaled(float* input, const t_feature_scaling* scaling) {
+        static_assert(Features == SAMPLE_FEATURES, "window features don't match t_packed_sample");
+        ring_window_t<t_packed_sample> window = sensor_history().window<WindowLen>();
+        int clamped = scale_span(input, window.first, scaling);
+        clamped += scale_span(input + window.first.size * Features, window.second, scaling);
+        return clamped;
+    }
     
-#endif
\ No newline at end of file
+#endif
@@ -3,6 +3,9 @@
     #ifndef DATA_STRUCTURE_H
     #define DATA_STRUCTURE_H
 
+    #include <stdint.h>
+    #include <stdbool.h>
+
     typedef struct bme280_sensor_output {
         float temperature;
         float humidity;
@@ -12,7 +15,10 @@
     typedef struct inference_result{
         long long int time;
         int tensor_usage;
+        bool valid;             // predicted_data holds a forecast
         t_bme280_s_val predicted_data[6];
+        bool degraded;          // Input window bridged a long gap in the history
+        uint8_t model;          // FORECASTER_FULL or FORECASTER_BASELINE
     }t_infered;
 
     #endif // BME280_SENSOR_OUTPUT_H
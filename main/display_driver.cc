@@ -1,6 +1,10 @@
 #include "display_driver.h"
 #include "bme280_driver.h"
+#include "circle_buffer.h"
+#include "framebuffer.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "i2c_bus.h"
 #include <stdio.h>
 #include <string.h>
@@ -17,173 +21,394 @@
 #define SSD1306_CMD_SET_COLUMN_ADDR     0x21
 #define SSD1306_CMD_SET_PAGE_ADDR       0x22
 
+#define SSD1306_CONTROL_COMMAND         0x00
+#define SSD1306_CONTROL_DATA            0x40
+
+#define DISPLAY_INIT_TIMEOUT_MS         500
+
+// Trend graph box: 3 px per hour, the hour axis of the history and the
+// forecast side by side, with the value axis labels to its left.
+#define TREND_FORECAST_HOURS            6
+#define TREND_POINTS                    (DISPLAY_TREND_HOURS + TREND_FORECAST_HOURS)
+#define TREND_PLOT_X                    (OLED_WIDTH - TREND_PLOT_W)
+#define TREND_PLOT_Y                    9
+#define TREND_PLOT_W                    ((TREND_POINTS - 1) * 3 + 1)
+#define TREND_PLOT_H                    (OLED_HEIGHT - TREND_PLOT_Y)
+
 static bool display_powered_on = false;
 static bool display_initialized = false;
 static i2c_bus_device_handle_t ssd1306_handle = NULL;
 
+// Init sequence for SSD1306, sent as one command stream. Ends by opening the
+// whole screen for the clear that follows.
+static const uint8_t init_commands[] = {
+    SSD1306_CMD_DISPLAY_OFF,
+    0xD5, 0x80,
+    0xA8, 0x3F,
+    0xD3, 0x00,
+    0x40,
+    0x8D, 0x14,
+    0x20, 0x00,
+    0xA1,
+    0xC8,
+    0xDA, 0x12,
+    SSD1306_CMD_SET_CONTRAST, 0xCF,
+    0xD9, 0xF1,
+    0xDB, 0x40,
+    0xA4,
+    0xA6,
+    SSD1306_CMD_SET_COLUMN_ADDR, 0, OLED_WIDTH - 1,
+    SSD1306_CMD_SET_PAGE_ADDR, 0, OLED_HEIGHT / 8 - 1,
+};
+static const uint8_t blank_page[OLED_WIDTH] = { 0 };
+
+// Pages are drawn into `frame`; `shown` is what the panel holds, so a flush
+// only sends what changed.
+static t_framebuffer frame;
+static uint8_t shown[FB_PAGES][FB_WIDTH];
+
+// display_init() queues the panel setup on the bus task and returns; it runs
+// while the sensor read, inference and Wi-Fi bring-up go ahead.
+static i2c_bus_segment_t init_batch[1 + OLED_HEIGHT / 8];
+static volatile esp_err_t init_result = ESP_OK;
+static bool init_pending = false;
+
+static i2c_bus_segment_t ssd1306_stream(uint8_t control, const uint8_t* data, size_t len) {
+    i2c_bus_segment_t seg = {};
+    seg.dev_handle = ssd1306_handle;
+    seg.mem_address = control;
+    seg.flags = I2C_BUS_SEGMENT_STREAM;
+    seg.data_len = len;
+    seg.write_buf = data;
+    return seg;
+}
+
+static void init_done(esp_err_t ret, void* ctx) {
+    init_result = ret;
+}
+
+static void send_init_sync(void) {
+    i2c_bus_write_bytes(ssd1306_handle, SSD1306_CONTROL_COMMAND, sizeof(init_commands), init_commands);
+    for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+        i2c_bus_write_bytes(ssd1306_handle, SSD1306_CONTROL_DATA, sizeof(blank_page), blank_page);
+    }
+}
+
+// Everything else sent to the panel has to come after the queued setup.
+// Until the batch has finished it may still be on the bus, so a slow one is
+// waited out (each transfer has its own bus timeout). A failed one is sent
+// again synchronously.
+static void wait_for_init(void) {
+    if (!init_pending) {
+        return;
+    }
+    while (i2c_bus_async_wait_idle(DISPLAY_INIT_TIMEOUT_MS) == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "Display setup still queued after %d ms", DISPLAY_INIT_TIMEOUT_MS);
+    }
+    init_pending = false;
+    if (init_result != ESP_OK) {
+        ESP_LOGW(TAG, "Queued display setup failed (%s), sending it again", esp_err_to_name(init_result));
+        send_init_sync();
+    }
+}
+
 static esp_err_t ssd1306_write_command(uint8_t cmd) {
-    uint8_t data[2] = {0x00, cmd};  
-    return i2c_bus_write_bytes(ssd1306_handle, 0x00, 1, &cmd);
+    return i2c_bus_write_bytes(ssd1306_handle, SSD1306_CONTROL_COMMAND, 1, &cmd);
 }
 
-static void ssd1306_clear_display(void) {
-    ssd1306_write_command(SSD1306_CMD_SET_COLUMN_ADDR);
-    ssd1306_write_command(0);
-    ssd1306_write_command(127);
-    
-    ssd1306_write_command(SSD1306_CMD_SET_PAGE_ADDR);
-    ssd1306_write_command(0);
-    ssd1306_write_command(7);
-    
-    uint8_t clear_data[128];
-    for (int i = 0; i < 128; i++) {
-        clear_data[i] = 0x00;
+// Sends the frame's pages that differ from what the panel shows. Each run
+// of adjacent pages goes out as one address window and one data write, and
+// is copied to `shown` only once both writes went through, so a failed run
+// is sent again by the next flush. Counts the pages sent in `sent`.
+static esp_err_t ssd1306_flush(const t_framebuffer* fb, int* sent) {
+    uint8_t changed = 0;
+    for (int page = 0; page < FB_PAGES; page++) {
+        if (memcmp(fb->pixels[page], shown[page], FB_WIDTH) != 0) {
+            changed |= (uint8_t)(1u << page);
+        }
     }
-    
-    for (int page = 0; page < 8; page++) {
-        i2c_bus_write_bytes(ssd1306_handle, 0x40, 128, clear_data);
+
+    *sent = 0;
+    int page = 0;
+    while (page < FB_PAGES) {
+        if (!(changed & (1u << page))) {
+            page++;
+            continue;
+        }
+        int first = page;
+        while (page < FB_PAGES && (changed & (1u << page))) {
+            page++;
+        }
+        uint8_t window[] = {
+            SSD1306_CMD_SET_COLUMN_ADDR, 0, FB_WIDTH - 1,
+            SSD1306_CMD_SET_PAGE_ADDR, (uint8_t)first, (uint8_t)(page - 1),
+        };
+        esp_err_t ret = i2c_bus_write_bytes(ssd1306_handle, SSD1306_CONTROL_COMMAND, sizeof(window), window);
+        if (ret == ESP_OK) {
+            ret = i2c_bus_write_bytes(ssd1306_handle, SSD1306_CONTROL_DATA, (page - first) * FB_WIDTH, fb->pixels[first]);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        memcpy(shown[first], fb->pixels[first], (page - first) * FB_WIDTH);
+        *sent += page - first;
     }
+    return ESP_OK;
 }
 
-static const uint8_t font_5x7[][5] = {
-    {0x00, 0x00, 0x00, 0x00, 0x00}, // Space (32)
-    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
-    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
-    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
-    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
-    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
-    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
-    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
-    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
-    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
-    {0x14, 0x08, 0x3E, 0x08, 0x14}, // *
-    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
-    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
-    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
-    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
-    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
-    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0 (48)
-    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
-    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
-    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
-    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
-    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
-    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
-    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
-    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
-    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
-    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
-    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
-    {0x08, 0x14, 0x22, 0x41, 0x00}, // <
-    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
-    {0x00, 0x41, 0x22, 0x14, 0x08}, // >
-    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
-    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
-    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A (65)
-    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
-    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
-    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
-    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
-    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
-    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
-    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
-    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
-    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
-    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
-    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
-    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
-    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
-    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
-    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
-    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
-    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
-    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
-    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
-    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
-    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
-    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
-    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
-    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
-    {0x00, 0x7F, 0x41, 0x41, 0x00}, // [
-    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
-    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
-    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
-    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
-    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
-    {0x20, 0x54, 0x54, 0x54, 0x78}, // a (97)
-    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
-    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
-    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
-    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
-    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // g
-    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
-    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
-    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
-    {0x7F, 0x10, 0x28, 0x44, 0x00}, // k
-    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
-    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
-    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
-    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
-    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
-    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
-    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
-    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
-    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
-    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
-    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
-    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
-    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
-    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
-};
+static void draw_text(t_framebuffer* fb, int x, int page, const char* text) {
+    fb_draw_text(fb, x, page * 8, text);
+}
 
-/**
- * Draw a single character at position
- */
-static void ssd1306_draw_char(uint8_t x, uint8_t page, char c) {
-    if (c < 32 || c > 122) {
-        c = ' ';  
+// Flushes `fb`, drawn (or found in the cache) since `started`, and logs
+// what it cost.
+static void present(const char* name, const t_framebuffer* fb, int64_t started, bool cached) {
+    int64_t rendered = esp_timer_get_time();
+    int pages;
+    esp_err_t ret = ssd1306_flush(fb, &pages);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s: flush failed after %d page(s): %s", name, pages, esp_err_to_name(ret));
+        return;
     }
-    
-    uint8_t char_index = c - 32;
-    uint8_t char_data[6];
-    
-    
-    for (int i = 0; i < 5; i++) {
-        char_data[i] = font_5x7[char_index][i];
+    ESP_LOGI(TAG, "%s: %s %lld us, flush %lld us (%d page(s))",
+             name, cached ? "cached" : "render", rendered - started, esp_timer_get_time() - rendered, pages);
+}
+
+// What a cached screen was rendered from. Zeroed before it is filled, so
+// whole keys can be compared with memcmp.
+typedef struct {
+    bool has_values;
+    t_bme280_s_val values;               // Reading for page 0, else that hour's prediction
+} t_page_key;
+
+typedef struct {
+    bool connected;
+    char ip_address[16];
+    int buffer_size;
+    int window_size;
+} t_network_key;
+
+typedef struct {
+    uint8_t observed;                    // Hours of history, newest last
+    uint8_t forecast;                    // 0 without a prediction
+    float series[TREND_POINTS];
+} t_trend_key;
+
+typedef union {
+    t_page_key page;
+    t_trend_key trend;
+    t_network_key network;
+} t_screen_key;
+
+typedef struct {
+    bool valid;
+    t_screen_key key;
+    t_framebuffer frame;
+} t_cached_screen;
+
+// The value pages and the network status stay rendered, so showing one
+// again is only a flush. They are keyed on the data they show: a new
+// reading or prediction re-renders the pages it changes on their next
+// show. Slot i holds page i, the last slot the network status.
+#define CACHE_SLOTS             (DISPLAY_PAGE_LAST + 2)
+#define CACHE_NETWORK_SLOT      (DISPLAY_PAGE_LAST + 1)
+
+static t_cached_screen* cache = NULL;
+static bool cache_unavailable = false;
+
+// NULL if there is no memory for the cache; screens then render into
+// `frame` every time.
+static t_cached_screen* cache_slot(int slot) {
+    if (cache == NULL && !cache_unavailable) {
+        cache = (t_cached_screen*)heap_caps_calloc(CACHE_SLOTS, sizeof(t_cached_screen), MALLOC_CAP_SPIRAM);
+        if (cache == NULL) {
+            cache = (t_cached_screen*)heap_caps_calloc(CACHE_SLOTS, sizeof(t_cached_screen), MALLOC_CAP_8BIT);
+        }
+        if (cache == NULL) {
+            ESP_LOGW(TAG, "No memory for the page cache");
+            cache_unavailable = true;
+        }
+    }
+    return cache != NULL ? &cache[slot] : NULL;
+}
+
+static void page_key(t_screen_key* key, uint8_t page_index, const t_infered* prediction_data,
+                     const t_bme280_s_val* sensor_data) {
+    memset(key, 0, sizeof(*key));
+    if (page_index == 0 && sensor_data != NULL) {
+        key->page.has_values = true;
+        key->page.values = *sensor_data;
+    } else if (page_index > 0 && prediction_data != NULL) {
+        key->page.has_values = true;
+        key->page.values = prediction_data->predicted_data[page_index - 1];
     }
-    char_data[5] = 0x00;  
-    
-    
-    ssd1306_write_command(SSD1306_CMD_SET_COLUMN_ADDR);
-    ssd1306_write_command(x);
-    ssd1306_write_command(x + 5);
-    
-    
-    ssd1306_write_command(SSD1306_CMD_SET_PAGE_ADDR);
-    ssd1306_write_command(page);
-    ssd1306_write_command(page);
-    
-    
-    i2c_bus_write_bytes(ssd1306_handle, 0x40, 6, char_data);
 }
 
+static float variable_value(const t_bme280_s_val* values, int variable) {
+    return variable == 0 ? values->temperature : (variable == 1 ? values->humidity : values->pressure);
+}
 
-static void ssd1306_draw_text(uint8_t x, uint8_t page, const char* text) {
-    uint8_t pos_x = x;
-    
-    for (int i = 0; text[i] != '\0'; i++) {
-        if (pos_x > 122) break;  
-        
-        ssd1306_draw_char(pos_x, page, text[i]);
-        pos_x += 6;  
+static void trend_key(t_screen_key* key, uint8_t page_index, const t_infered* prediction_data) {
+    memset(key, 0, sizeof(*key));
+    int variable = page_index - DISPLAY_PAGE_TREND_TEMPERATURE;
+
+    t_bme280_s_val history[DISPLAY_TREND_HOURS];
+    int n = history_size() < DISPLAY_TREND_HOURS ? history_size() : DISPLAY_TREND_HOURS;
+    n = yield_history(history, n);
+    for (int i = 0; i < n; i++) {
+        key->trend.series[i] = variable_value(&history[i], variable);
+    }
+    key->trend.observed = (uint8_t)n;
+
+    if (prediction_data != NULL && prediction_data->valid) {
+        for (int h = 0; h < TREND_FORECAST_HOURS; h++) {
+            key->trend.series[n + h] = variable_value(&prediction_data->predicted_data[h], variable);
+        }
+        key->trend.forecast = TREND_FORECAST_HOURS;
+    }
+}
+
+static void network_key(t_screen_key* key, bool connected, const char* ip_address, int buffer_size, int window_size) {
+    memset(key, 0, sizeof(*key));
+    key->network.connected = connected;
+    if (ip_address != NULL) {
+        strncpy(key->network.ip_address, ip_address, sizeof(key->network.ip_address) - 1);
     }
+    key->network.buffer_size = buffer_size;
+    key->network.window_size = window_size;
+}
+
+// A reading on two pages: its name on the first, the value in double size
+// digits, and the unit next to their lower half.
+static void draw_reading(t_framebuffer* fb, int page, const char* name, const char* value, const char* unit) {
+    constexpr int unit_x = OLED_WIDTH - fb_text_width("hPa");
+    draw_text(fb, 0, page, name);
+    fb_draw_text_scaled(fb, unit_x - 2 - fb_text_width(value, 2), page * 8, value, 2);
+    draw_text(fb, unit_x, page + 1, unit);
+}
+
+static void render_value_page(t_framebuffer* fb, uint8_t page_index, const t_page_key* key) {
+    // Every "+N HOUR" title is as wide as this one.
+    constexpr int current_x = fb_center_x("CURRENT");
+    constexpr int hour_x = fb_center_x("+0 HOUR");
+    char buffer[16];
+    const t_bme280_s_val* values = &key->values;
+
+    if (page_index == 0) {
+        draw_text(fb, current_x, 0, "CURRENT");
+    } else {
+        snprintf(buffer, sizeof(buffer), "+%d HOUR", page_index);
+        draw_text(fb, hour_x, 0, buffer);
+    }
+    draw_text(fb, 0, 1, "---------------------");
+
+    if (!key->has_values) {
+        draw_text(fb, 10, 3, page_index == 0 ? "No Data" : "No Prediction");
+        return;
+    }
+    snprintf(buffer, sizeof(buffer), "%.1f", values->temperature);
+    draw_reading(fb, 2, "Temp", buffer, "C");
+    snprintf(buffer, sizeof(buffer), "%.1f", values->humidity);
+    draw_reading(fb, 4, "Hum", buffer, "%");
+    snprintf(buffer, sizeof(buffer), "%.0f", values->pressure);
+    draw_reading(fb, 6, "Pres", buffer, "hPa");
+}
+
+typedef struct {
+    const char* title;
+    const char* format;                  // Current value and axis labels
+    float min_span;                      // Smallest value axis
+} t_trend_variable;
+
+static const t_trend_variable trend_variables[3] = {
+    { "TEMP C",       "%.1f", 2.0f },
+    { "HUMIDITY %",   "%.0f", 6.0f },
+    { "PRESSURE hPa", "%.0f", 4.0f },
+};
+
+static int trend_x(int hour) {
+    return TREND_PLOT_X + hour * (TREND_PLOT_W - 1) / (TREND_POINTS - 1);
+}
+
+// History solid up to now, the forecast dotted after it, on a value axis
+// fitted to both. The hour axis is fixed, so now is always at the same
+// place and a short history starts further right.
+static void render_trend_page(t_framebuffer* fb, uint8_t page_index, const t_trend_key* key) {
+    char buffer[16];
+    const t_trend_variable* variable = &trend_variables[page_index - DISPLAY_PAGE_TREND_TEMPERATURE];
+
+    fb_draw_text(fb, 0, 0, variable->title);
+    if (key->observed == 0) {
+        draw_text(fb, 10, 3, "No History");
+        return;
+    }
+
+    int n = key->observed + key->forecast;
+    snprintf(buffer, sizeof(buffer), variable->format, key->series[key->observed - 1]);
+    fb_draw_text(fb, OLED_WIDTH - fb_text_width(buffer), 0, buffer);
+
+    float lo, hi;
+    fb_series_range(key->series, n, variable->min_span, &lo, &hi);
+    snprintf(buffer, sizeof(buffer), variable->format, hi);
+    fb_draw_text(fb, 0, TREND_PLOT_Y, buffer);
+    snprintf(buffer, sizeof(buffer), variable->format, lo);
+    fb_draw_text(fb, 0, OLED_HEIGHT - FB_GLYPH_HEIGHT, buffer);
+    fb_vline(fb, TREND_PLOT_X - 2, TREND_PLOT_Y, TREND_PLOT_H);
+
+    int first = DISPLAY_TREND_HOURS - key->observed;
+    int now = trend_x(DISPLAY_TREND_HOURS - 1);
+    fb_line(fb, now, TREND_PLOT_Y, now, OLED_HEIGHT - 1, FB_LINE_DOTTED);
+    fb_plot_series(fb, trend_x(first), TREND_PLOT_Y, trend_x(first + n - 1) - trend_x(first) + 1, TREND_PLOT_H,
+                   key->series, n, lo, hi, key->observed);
+}
+
+static void render_network_status(t_framebuffer* fb, const t_network_key* key) {
+    constexpr int title_x = fb_center_x("NETWORK STATUS");
+    char buffer[64];
+
+    draw_text(fb, title_x, 0, "NETWORK STATUS");
+    draw_text(fb, 0, 1, "---------------------");
     
-    ESP_LOGI(TAG, "Display [%d,%d]: %s", x, page, text);
+    // Connection status
+    if (key->connected) {
+        draw_text(fb, 0, 3, "Status: Connected");
+        if (key->ip_address[0] != '\0') {
+            snprintf(buffer, sizeof(buffer), "IP: %s", key->ip_address);
+            draw_text(fb, 0, 4, buffer);
+        }
+    } else {
+        draw_text(fb, 0, 3, "Status: Disconnected");
+    }
+
+    // Buffer size
+    snprintf(buffer, sizeof(buffer), "Buffer: %d / %d", key->buffer_size, key->window_size);
+    draw_text(fb, 0, 6, buffer);
 }
 
+// The frame for the screen in `slot`, rendered first unless the cache
+// already holds it for `key`.
+static t_framebuffer* screen_frame(int slot, const t_screen_key* key, bool* cached) {
+    t_cached_screen* entry = cache_slot(slot);
+    *cached = entry != NULL && entry->valid && memcmp(&entry->key, key, sizeof(*key)) == 0;
+    if (*cached) {
+        return &entry->frame;
+    }
+
+    t_framebuffer* fb = entry != NULL ? &entry->frame : &frame;
+    fb_clear(fb);
+    if (slot == CACHE_NETWORK_SLOT) {
+        render_network_status(fb, &key->network);
+    } else if (slot > DISPLAY_PAGE_MAX) {
+        render_trend_page(fb, (uint8_t)slot, &key->trend);
+    } else {
+        render_value_page(fb, (uint8_t)slot, &key->page);
+    }
+    if (entry != NULL) {
+        entry->key = *key;
+        entry->valid = true;
+    }
+    return fb;
+}
 
 esp_err_t display_init(void) {
     i2c_bus_handle_t bus = get_i2c_bus_handle();
@@ -195,42 +420,28 @@ esp_err_t display_init(void) {
     ESP_LOGI(TAG, "Initializing SSD1306 display...");
     
     
-    ssd1306_handle = i2c_bus_device_create(bus, OLED_I2C_ADDRESS, 0);
+    ssd1306_handle = i2c_bus_device_create(bus, OLED_I2C_ADDRESS, OLED_I2C_CLOCK_HZ);
     if (ssd1306_handle == NULL) {
         ESP_LOGE(TAG, "Failed to create SSD1306 device handle");
         return ESP_FAIL;
     }
     
-    // Init sequence for SSD1306
-    ssd1306_write_command(SSD1306_CMD_DISPLAY_OFF);
-    ssd1306_write_command(0xD5);
-    ssd1306_write_command(0x80);
-    ssd1306_write_command(0xA8); 
-    ssd1306_write_command(0x3F);
-    ssd1306_write_command(0xD3); 
-    ssd1306_write_command(0x00);
-    ssd1306_write_command(0x40); 
-    ssd1306_write_command(0x8D); 
-    ssd1306_write_command(0x14);
-    ssd1306_write_command(0x20); 
-    ssd1306_write_command(0x00);
-    ssd1306_write_command(0xA1); 
-    ssd1306_write_command(0xC8); 
-    ssd1306_write_command(0xDA); 
-    ssd1306_write_command(0x12);
-    ssd1306_write_command(SSD1306_CMD_SET_CONTRAST);
-    ssd1306_write_command(0xCF);
-    ssd1306_write_command(0xD9); 
-    ssd1306_write_command(0xF1);
-    ssd1306_write_command(0xDB); 
-    ssd1306_write_command(0x40);
-    ssd1306_write_command(0xA4); 
-    ssd1306_write_command(0xA6);
-    
-    ssd1306_clear_display();
-    
-    display_off();
-    
+    // Panel setup and a blank screen, left off. Queued if the bus task is
+    // available, otherwise sent here.
+    init_batch[0] = ssd1306_stream(SSD1306_CONTROL_COMMAND, init_commands, sizeof(init_commands));
+    for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+        init_batch[1 + page] = ssd1306_stream(SSD1306_CONTROL_DATA, blank_page, sizeof(blank_page));
+    }
+    init_result = ESP_OK;
+    init_pending = i2c_bus_async_init() == ESP_OK &&
+                   i2c_bus_submit(init_batch, sizeof(init_batch) / sizeof(init_batch[0]), init_done, NULL) == ESP_OK;
+    if (!init_pending) {
+        send_init_sync();
+    }
+    fb_clear(&frame);
+    memset(shown, 0, sizeof(shown));
+    display_powered_on = false;
+
     display_initialized = true;
     ESP_LOGI(TAG, "Display initialized successfully (OFF by default)");
     return ESP_OK;
@@ -238,7 +449,10 @@ esp_err_t display_init(void) {
 
 void display_clear(void) {
     if (display_initialized) {
-        ssd1306_clear_display();
+        wait_for_init();
+        int64_t started = esp_timer_get_time();
+        fb_clear(&frame);
+        present("Clear", &frame, started, false);
     }
 }
 
@@ -246,103 +460,80 @@ void display_show_page(uint8_t page_index, const t_infered* prediction_data, con
     if (!display_initialized) {
         return;
     }
+    wait_for_init();
 
-    if (page_index > DISPLAY_PAGE_MAX) {
-        page_index = DISPLAY_PAGE_MAX;
+    if (page_index > DISPLAY_PAGE_LAST) {
+        page_index = DISPLAY_PAGE_LAST;
     }
 
-    char buffer[64];
-    
-    ssd1306_clear_display();
-    
-    if (page_index == 0) {
-        ssd1306_draw_text(43, 0, "CURRENT");
-        ssd1306_draw_text(0, 1, "---------------------");
-        
-        if (sensor_data != NULL) {
-            snprintf(buffer, sizeof(buffer), " Temp: %.1f C", sensor_data->temperature);
-            ssd1306_draw_text(0, 2, buffer);
-            
-            snprintf(buffer, sizeof(buffer), " Hum : %.1f %%", sensor_data->humidity);
-            ssd1306_draw_text(0, 4, buffer);
-            
-            snprintf(buffer, sizeof(buffer), " Pres: %.0f hPa", sensor_data->pressure);
-            ssd1306_draw_text(0, 6, buffer);
-        } else {
-            ssd1306_draw_text(10, 3, "No Data");
-        }
-    } 
-
-    else {
-        int pred_idx = page_index - 1;
-        
-        snprintf(buffer, sizeof(buffer), "+%d HOUR PREDICTION", page_index);
-
-        snprintf(buffer, sizeof(buffer), "+%d HOUR", page_index);
-        int len = strlen(buffer);
-        int x = (128 - (len * 6)) / 2;
-        ssd1306_draw_text(x, 0, buffer);
-        
-        ssd1306_draw_text(0, 1, "---------------------");
-        
-        if (prediction_data != NULL) {
-            snprintf(buffer, sizeof(buffer), " Temp: %.1f C", prediction_data->predicted_data[pred_idx].temperature);
-            ssd1306_draw_text(0, 2, buffer);
-            
-            snprintf(buffer, sizeof(buffer), " Hum : %.1f %%", prediction_data->predicted_data[pred_idx].humidity);
-            ssd1306_draw_text(0, 4, buffer);
-            
-            snprintf(buffer, sizeof(buffer), " Pres: %.0f hPa", prediction_data->predicted_data[pred_idx].pressure);
-            ssd1306_draw_text(0, 6, buffer);
-        } else {
-             ssd1306_draw_text(10, 3, "No Prediction");
-        }
+    int64_t started = esp_timer_get_time();
+    t_screen_key key;
+    if (page_index > DISPLAY_PAGE_MAX) {
+        trend_key(&key, page_index, prediction_data);
+    } else {
+        page_key(&key, page_index, prediction_data, sensor_data);
     }
+    bool cached;
+    t_framebuffer* fb = screen_frame(page_index, &key, &cached);
+    present("Page", fb, started, cached);
 }
 
-void display_show_network_status(bool connected, const char* ip_address, int buffer_size) {
+void display_show_network_status(bool connected, const char* ip_address, int buffer_size, int window_size) {
     if (!display_initialized) {
         return;
     }
+    wait_for_init();
 
-    char buffer[64];
-    
-    ssd1306_clear_display();
+    int64_t started = esp_timer_get_time();
+    t_screen_key key;
+    network_key(&key, connected, ip_address, buffer_size, window_size);
+    bool cached;
+    t_framebuffer* fb = screen_frame(CACHE_NETWORK_SLOT, &key, &cached);
+    present("Network status", fb, started, cached);
+}
 
-    ssd1306_draw_text(22, 0, "NETWORK STATUS");
-    ssd1306_draw_text(0, 1, "---------------------");
-    
-    // Connection status
-    if (connected) {
-        ssd1306_draw_text(0, 3, "Status: Connected");
-        if (ip_address != NULL) {
-            snprintf(buffer, sizeof(buffer), "IP: %s", ip_address);
-            ssd1306_draw_text(0, 4, buffer);
-        }
-    } else {
-        ssd1306_draw_text(0, 3, "Status: Disconnected");
+void display_prerender(const t_infered* prediction_data, const t_bme280_s_val* sensor_data,
+                       bool connected, const char* ip_address, int buffer_size, int window_size) {
+    if (!display_initialized || cache_slot(0) == NULL) {
+        return;
     }
 
-    // Buffer size
-    snprintf(buffer, sizeof(buffer), "Buffer: %d / 24", buffer_size);
-    ssd1306_draw_text(0, 6, buffer);
+    int64_t started = esp_timer_get_time();
+    t_screen_key key;
+    bool cached;
+    for (int page = 0; page <= DISPLAY_PAGE_LAST; page++) {
+        if (page > DISPLAY_PAGE_MAX) {
+            trend_key(&key, (uint8_t)page, prediction_data);
+        } else {
+            page_key(&key, (uint8_t)page, prediction_data, sensor_data);
+        }
+        screen_frame(page, &key, &cached);
+    }
+    network_key(&key, connected, ip_address, buffer_size, window_size);
+    screen_frame(CACHE_NETWORK_SLOT, &key, &cached);
+    ESP_LOGI(TAG, "Pre-rendered %d screens in %lld us", CACHE_SLOTS, esp_timer_get_time() - started);
 }
 
 void display_show_sleep_warning(void) {
     if (!display_initialized) {
         return;
     }
+    wait_for_init();
 
-    ssd1306_clear_display();
+    int64_t started = esp_timer_get_time();
+    fb_clear(&frame);
     
-    ssd1306_draw_text(10, 2, "SLEEP MODE");
-    ssd1306_draw_text(0, 4, "Release to sleep");
+    draw_text(&frame, 10, 2, "SLEEP MODE");
+    draw_text(&frame, 0, 4, "Release to sleep");
+
+    present("Sleep warning", &frame, started, false);
 }
 
 void display_on(void) {
     if (!display_initialized) {
         return;
     }
+    wait_for_init();
     
     if (!display_powered_on) {
         ssd1306_write_command(SSD1306_CMD_DISPLAY_ON);
@@ -355,8 +546,11 @@ void display_off(void) {
     if (!display_initialized) {
         return;
     }
+    wait_for_init();
     
-    ssd1306_clear_display();
+    int64_t started = esp_timer_get_time();
+    fb_clear(&frame);
+    present("Off", &frame, started, false);
     ssd1306_write_command(SSD1306_CMD_DISPLAY_OFF);
     display_powered_on = false;
     ESP_LOGI(TAG, "Display turned OFF");
@@ -365,3 +559,7 @@ void display_off(void) {
 bool display_is_on(void) {
     return display_powered_on;
 }
+
+i2c_bus_device_handle_t get_display_i2c_device(void) {
+    return ssd1306_handle;
+}
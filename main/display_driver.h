@@ -5,9 +5,16 @@
 
 #include "data_structure.h"
 #include "esp_err.h"
+#include "i2c_bus.h"
 #include <stdbool.h>
 #include <stdint.h>
 
+// SSD1306 clock, independent of the bus clock. The datasheet rates the
+// controller for 400 kHz; most modules also run at 1 MHz on short wiring.
+#ifndef OLED_I2C_CLOCK_HZ
+#define OLED_I2C_CLOCK_HZ   400000
+#endif
+
 // Display page indices
 typedef enum {
     DISPLAY_PAGE_0 = 0,  // Current hour
@@ -17,17 +24,34 @@ typedef enum {
     DISPLAY_PAGE_4 = 4,  // +4 hours
     DISPLAY_PAGE_5 = 5,  // +5 hours
     DISPLAY_PAGE_6 = 6,  // +6 hours
-    DISPLAY_PAGE_MAX = 6
+    DISPLAY_PAGE_MAX = 6,  // Last value page
+    DISPLAY_PAGE_TREND_TEMPERATURE = 7,
+    DISPLAY_PAGE_TREND_HUMIDITY = 8,
+    DISPLAY_PAGE_TREND_PRESSURE = 9,
+    DISPLAY_PAGE_LAST = 9
 } display_page_t;
 
+// Hours of history on the trend pages, ahead of the six forecast hours.
+#define DISPLAY_TREND_HOURS 24
+
 // Initialize the display driver
 esp_err_t display_init(void);
 
-// Display a page (0 = Current, 1-5 = Prediction)
+// Display a page (0 = Current, 1-6 = Prediction, then one trend graph per
+// variable: the last DISPLAY_TREND_HOURS of history, read from the RTC
+// buffer, and the prediction dotted after it)
 void display_show_page(uint8_t page_index, const t_infered* prediction_data, const t_bme280_s_val* sensor_data);
 
-// Display network status (connected/disconnected with IP and buffer size)
-void display_show_network_status(bool connected, const char* ip_address, int buffer_size);
+// Display network status (connected/disconnected with IP, and buffered samples
+// against the model window)
+void display_show_network_status(bool connected, const char* ip_address, int buffer_size, int window_size);
+
+// Renders every page and the network status into the page cache, so
+// the show calls above only flush. Screens are cached against the data they
+// show and re-render by themselves when it changes; this just moves the
+// work in front of the first button press.
+void display_prerender(const t_infered* prediction_data, const t_bme280_s_val* sensor_data,
+                       bool connected, const char* ip_address, int buffer_size, int window_size);
 
 // Display sleep warning screen
 void display_show_sleep_warning(void);
@@ -44,4 +68,8 @@ void display_off(void);
 // Check if display is currently on
 bool display_is_on(void);
 
+// The display's device on the bus, for i2c_bus_device_get_stats(). NULL
+// before display_init().
+i2c_bus_device_handle_t get_display_i2c_device(void);
+
 #endif // DISPLAY_DRIVER_H
@@ -0,0 +1,115 @@
+#include "forecast_skill.h"
+#include "model_selector.h"
+#include "esp_attr.h"
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t count;
+    t_bme280_s_val mean_abs;
+    t_bme280_s_val mean_sq;
+    t_bme280_s_val mean_err;
+} t_horizon_skill;
+
+typedef struct {
+    t_skill_forecast forecasts[SKILL_FORECASTS];
+    uint8_t next;
+    uint16_t since_report;
+    t_horizon_skill horizons[SKILL_MODELS][SKILL_HORIZONS];
+} t_skill_state;
+
+static_assert(FORECASTER_FULL < SKILL_MODELS && FORECASTER_BASELINE < SKILL_MODELS,
+              "one skill table per forecaster");
+
+static RTC_DATA_ATTR t_skill_state skill;
+
+static void running_mean(float* mean, float x, uint32_t n) {
+    *mean += (x - *mean) / n;
+}
+
+static void score(t_horizon_skill* h, const t_bme280_s_val* predicted, const t_bme280_s_val* observed) {
+    float err[3] = {
+        predicted->temperature - observed->temperature,
+        predicted->humidity - observed->humidity,
+        predicted->pressure - observed->pressure,
+    };
+    float* mean_abs[3] = { &h->mean_abs.temperature, &h->mean_abs.humidity, &h->mean_abs.pressure };
+    float* mean_sq[3] = { &h->mean_sq.temperature, &h->mean_sq.humidity, &h->mean_sq.pressure };
+    float* mean_err[3] = { &h->mean_err.temperature, &h->mean_err.humidity, &h->mean_err.pressure };
+
+    h->count++;
+    for (int i = 0; i < 3; i++) {
+        running_mean(mean_abs[i], fabsf(err[i]), h->count);
+        running_mean(mean_sq[i], err[i] * err[i], h->count);
+        running_mean(mean_err[i], err[i], h->count);
+    }
+}
+
+void forecast_skill_reset(void) {
+    memset(&skill, 0, sizeof(skill));
+}
+
+void forecast_skill_record(uint32_t issued_ts, const t_infered* forecast) {
+    if (forecast->model >= SKILL_MODELS) {
+        return;
+    }
+    t_skill_forecast* slot = &skill.forecasts[skill.next];
+    slot->issued_ts = issued_ts;
+    slot->scored = 0;
+    slot->model = forecast->model;
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        slot->predicted[h] = pack_sample(&forecast->predicted_data[h]);
+    }
+    skill.next = (skill.next + 1) % SKILL_FORECASTS;
+}
+
+int forecast_skill_observe(uint32_t timestamp, const t_bme280_s_val* observed) {
+    int scored = 0;
+    for (int i = 0; i < SKILL_FORECASTS; i++) {
+        t_skill_forecast* f = &skill.forecasts[i];
+        int horizon = forecast_horizon(f->issued_ts, timestamp);
+        if (horizon == 0) {
+            continue;
+        }
+        uint8_t bit = (uint8_t)(1u << (horizon - 1));
+        if (f->scored & bit) {
+            continue;
+        }
+        t_bme280_s_val predicted = unpack_sample(f->predicted[horizon - 1]);
+        score(&skill.horizons[f->model][horizon - 1], &predicted, observed);
+        f->scored |= bit;
+        scored++;
+    }
+    if (skill.since_report < UINT16_MAX) {
+        skill.since_report++;
+    }
+    return scored;
+}
+
+void forecast_skill_summary(uint8_t model, t_skill_summary* summary) {
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        const t_horizon_skill* s = &skill.horizons[model][h];
+        summary->count[h] = s->count;
+        summary->mae[h] = s->mean_abs;
+        summary->rmse[h] = {
+            sqrtf(s->mean_sq.temperature),
+            sqrtf(s->mean_sq.humidity),
+            sqrtf(s->mean_sq.pressure),
+        };
+        summary->bias[h] = s->mean_err;
+    }
+}
+
+bool forecast_skill_pending_report(t_skill_summary summaries[SKILL_MODELS]) {
+    if (skill.since_report < SKILL_REPORT_HOURS) {
+        return false;
+    }
+    for (uint8_t m = 0; m < SKILL_MODELS; m++) {
+        forecast_skill_summary(m, &summaries[m]);
+    }
+    return true;
+}
+
+void forecast_skill_ack_report(void) {
+    skill.since_report = 0;
+}
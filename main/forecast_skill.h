@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef FORECAST_SKILL_H
+#define FORECAST_SKILL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_structure.h"
+#include "packed_sample.h"
+
+// Scores the forecasts this node issued against what it observed later.
+// The last SKILL_FORECASTS forecasts are kept in RTC memory; each hourly
+// observation is matched to the forecast step issued that many hours
+// earlier. Per model, horizon and variable, MAE, mean squared error and
+// bias are kept as running means, so memory stays constant however long it
+// runs. Each forecast is scored under the model that issued it, so baseline
+// runs don't blur the full model's numbers.
+
+#define SKILL_HORIZONS          6       // Steps in t_infered::predicted_data
+#define SKILL_FORECASTS         SKILL_HORIZONS
+#define SKILL_MODELS            2       // Indexed by t_infered::model
+#define SKILL_REPORT_HOURS      24
+
+typedef struct {
+    uint32_t issued_ts;                  // 0 = empty slot
+    uint8_t  scored;                     // Bit h-1 set once horizon h is scored
+    uint8_t  model;
+    t_packed_sample predicted[SKILL_HORIZONS];
+} t_skill_forecast;
+
+typedef struct {
+    uint32_t count[SKILL_HORIZONS];
+    t_bme280_s_val mae[SKILL_HORIZONS];
+    t_bme280_s_val rmse[SKILL_HORIZONS];
+    t_bme280_s_val bias[SKILL_HORIZONS];  // Mean of forecast - observed
+} t_skill_summary;
+
+// Forecast step (1..SKILL_HORIZONS) of a forecast issued at `issued_ts`
+// that falls due at `timestamp`, to the nearest hour. 0 if none does.
+static inline int forecast_horizon(uint32_t issued_ts, uint32_t timestamp) {
+    if (issued_ts == 0 || timestamp <= issued_ts) {
+        return 0;
+    }
+    uint32_t horizon = (timestamp - issued_ts + 1800) / 3600;
+    return horizon <= SKILL_HORIZONS ? (int)horizon : 0;
+}
+
+// Drops stored forecasts and scores (cold boot).
+void forecast_skill_reset(void);
+
+// Keeps `forecast`, issued at `issued_ts` (seconds), for later scoring.
+void forecast_skill_record(uint32_t issued_ts, const t_infered* forecast);
+
+// Scores every stored forecast with a step due at `timestamp` against
+// `observed`. Returns how many horizons were scored.
+int forecast_skill_observe(uint32_t timestamp, const t_bme280_s_val* observed);
+
+void forecast_skill_summary(uint8_t model, t_skill_summary* summary);
+
+// Fills `summaries`, one per model, and returns true once
+// SKILL_REPORT_HOURS observations have passed since the last acknowledged
+// report. The report stays due until forecast_skill_ack_report().
+bool forecast_skill_pending_report(t_skill_summary summaries[SKILL_MODELS]);
+
+// Marks the pending report as delivered.
+void forecast_skill_ack_report(void);
+
+#endif
@@ -0,0 +1,313 @@
+#include "framebuffer.h"
+#include <string.h>
+
+#define FONT_FIRST          ' '
+#define FONT_LAST           'z'
+
+static constexpr uint8_t font_5x7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // Space (32)
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
+    {0x14, 0x08, 0x3E, 0x08, 0x14}, // *
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0 (48)
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // <
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // >
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A (65)
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
+    {0x00, 0x7F, 0x41, 0x41, 0x00}, // [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
+    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
+    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // a (97)
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
+    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // k
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
+    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
+};
+
+// Glyphs for the characters First..Last at Scale times the 5x7 size, each
+// already in the frame's layout: cells[glyph][page] is the run of column
+// bytes for one 8-row page of the glyph, blank spacing column included, so
+// a page-aligned glyph is a memcpy per page.
+template <int Scale, char First, char Last>
+struct t_glyph_atlas {
+    static constexpr int kPitch = FB_GLYPH_WIDTH * Scale;
+    uint8_t cells[Last - First + 1][Scale][kPitch];
+};
+
+template <int Scale, char First, char Last>
+constexpr t_glyph_atlas<Scale, First, Last> make_atlas() {
+    static_assert(First >= FONT_FIRST && Last <= FONT_LAST && First <= Last, "atlas outside the font");
+    t_glyph_atlas<Scale, First, Last> atlas = {};
+    for (int g = 0; g <= Last - First; g++) {
+        const uint8_t* glyph = font_5x7[First - FONT_FIRST + g];
+        for (int col = 0; col < 5 * Scale; col++) {
+            uint8_t bits = glyph[col / Scale];
+            for (int row = 0; row < 8 * Scale; row++) {
+                if ((bits >> (row / Scale)) & 1) {
+                    atlas.cells[g][row / 8][col] |= (uint8_t)(1u << (row % 8));
+                }
+            }
+        }
+    }
+    return atlas;
+}
+
+// The whole font, and digits with "+,-./" in the two larger sizes.
+static constexpr auto font_1x = make_atlas<1, FONT_FIRST, FONT_LAST>();
+static constexpr auto font_2x = make_atlas<2, '+', '9'>();
+static constexpr auto font_3x = make_atlas<3, '+', '9'>();
+
+static_assert(font_1x.cells['A' - FONT_FIRST][0][0] == 0x7E && font_1x.cells['A' - FONT_FIRST][0][5] == 0,
+              "1x atlas is the 5x7 font plus a spacing column");
+static_assert(font_2x.cells['1' - '+'][0][2] == 0x0C && font_2x.cells['1' - '+'][1][2] == 0x30,
+              "2x glyphs are doubled across pages");
+static_assert(font_3x.cells['8' - '+'][0][0] == 0xF8 && font_3x.cells['8' - '+'][1][0] == 0xF1,
+              "3x glyphs are tripled across pages");
+
+// ORs 8 rows of one column in at (x, y), y anywhere from -7 on.
+static void blit_column(t_framebuffer* fb, int x, int y, uint8_t bits) {
+    if (x < 0 || x >= FB_WIDTH || bits == 0) {
+        return;
+    }
+    int shift = y & 7;
+    int page = (y - shift) / 8;
+    if (page >= 0 && page < FB_PAGES) {
+        fb->pixels[page][x] |= (uint8_t)(bits << shift);
+    }
+    if (shift != 0 && page + 1 >= 0 && page + 1 < FB_PAGES) {
+        fb->pixels[page + 1][x] |= (uint8_t)(bits >> (8 - shift));
+    }
+}
+
+void fb_clear(t_framebuffer* fb) {
+    memset(fb->pixels, 0, sizeof(fb->pixels));
+}
+
+void fb_set_pixel(t_framebuffer* fb, int x, int y, bool on) {
+    if (x < 0 || x >= FB_WIDTH || y < 0 || y >= FB_HEIGHT) {
+        return;
+    }
+    uint8_t bit = (uint8_t)(1u << (y & 7));
+    if (on) {
+        fb->pixels[y >> 3][x] |= bit;
+    } else {
+        fb->pixels[y >> 3][x] &= (uint8_t)~bit;
+    }
+}
+
+void fb_fill_rect(t_framebuffer* fb, int x, int y, int w, int h, bool on) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > FB_WIDTH ? FB_WIDTH : x + w;
+    int y1 = y + h > FB_HEIGHT ? FB_HEIGHT : y + h;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+        int top = y0 > page * 8 ? y0 - page * 8 : 0;
+        int bottom = y1 < page * 8 + 8 ? y1 - page * 8 : 8;
+        uint8_t mask = (uint8_t)((0xFFu << top) & (0xFFu >> (8 - bottom)));
+        uint8_t* row = fb->pixels[page];
+        for (int i = x0; i < x1; i++) {
+            row[i] = on ? (uint8_t)(row[i] | mask) : (uint8_t)(row[i] & ~mask);
+        }
+    }
+}
+
+void fb_hline(t_framebuffer* fb, int x, int y, int w) {
+    fb_fill_rect(fb, x, y, w, 1, true);
+}
+
+void fb_vline(t_framebuffer* fb, int x, int y, int h) {
+    fb_fill_rect(fb, x, y, 1, h, true);
+}
+
+void fb_line(t_framebuffer* fb, int x0, int y0, int x1, int y1, uint8_t pattern) {
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0;    // Negative
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    for (int i = 0;; i++) {
+        if (pattern & (1u << (i & 7))) {
+            fb_set_pixel(fb, x0, y0, true);
+        }
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        int e2 = 2 * error;
+        if (e2 >= dy) {
+            error += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            error += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void fb_series_range(const float* values, int n, float min_span, float* lo, float* hi) {
+    float min = n > 0 ? values[0] : 0.0f;
+    float max = min;
+    for (int i = 1; i < n; i++) {
+        min = values[i] < min ? values[i] : min;
+        max = values[i] > max ? values[i] : max;
+    }
+    if (max - min < min_span) {
+        float mid = (min + max) / 2.0f;
+        min = mid - min_span / 2.0f;
+        max = mid + min_span / 2.0f;
+    }
+    *lo = min;
+    *hi = max;
+}
+
+void fb_plot_series(t_framebuffer* fb, int x, int y, int w, int h,
+                    const float* values, int n, float lo, float hi, int dotted_from) {
+    if (n <= 0 || w <= 0 || h <= 0) {
+        return;
+    }
+    float scale = hi > lo ? (h - 1) / (hi - lo) : 0.0f;
+    int prev_x = 0, prev_y = 0;
+    for (int i = 0; i < n; i++) {
+        float v = values[i] < lo ? lo : (values[i] > hi ? hi : values[i]);
+        int px = n > 1 ? x + (i * (w - 1) + (n - 1) / 2) / (n - 1) : x + (w - 1) / 2;
+        int py = y + (h - 1) - (int)((v - lo) * scale + 0.5f);
+        if (i == 0) {
+            fb_set_pixel(fb, px, py, true);
+        } else {
+            fb_line(fb, prev_x, prev_y, px, py, i >= dotted_from ? FB_LINE_DOTTED : FB_LINE_SOLID);
+        }
+        prev_x = px;
+        prev_y = py;
+    }
+}
+
+// Draws text from `atlas`, overwriting each glyph's cell; characters it
+// does not cover draw as blank cells. On a page boundary each glyph page is
+// copied straight in, anywhere else it is shifted in column by column.
+template <int Scale, char First, char Last>
+static int draw_glyphs(t_framebuffer* fb, const t_glyph_atlas<Scale, First, Last>& atlas,
+                       int x, int y, const char* text) {
+    constexpr int pitch = t_glyph_atlas<Scale, First, Last>::kPitch;
+    bool aligned = (y & 7) == 0;
+    for (int i = 0; text[i] != '\0'; i++) {
+        if (x + pitch > FB_WIDTH) {
+            break;
+        }
+        char c = text[i];
+        const uint8_t (*cell)[pitch] = c >= First && c <= Last ? atlas.cells[c - First] : NULL;
+        if (aligned && x >= 0) {
+            for (int p = 0; p < Scale; p++) {
+                int page = y / 8 + p;
+                if (page < 0 || page >= FB_PAGES) {
+                    continue;
+                }
+                if (cell != NULL) {
+                    memcpy(&fb->pixels[page][x], cell[p], pitch);
+                } else {
+                    memset(&fb->pixels[page][x], 0, pitch);
+                }
+            }
+        } else {
+            fb_fill_rect(fb, x, y, pitch, FB_GLYPH_HEIGHT * Scale, false);
+            for (int p = 0; cell != NULL && p < Scale; p++) {
+                for (int col = 0; col < pitch; col++) {
+                    blit_column(fb, x + col, y + p * 8, cell[p][col]);
+                }
+            }
+        }
+        x += pitch;
+    }
+    return x;
+}
+
+int fb_draw_text(t_framebuffer* fb, int x, int y, const char* text) {
+    return draw_glyphs(fb, font_1x, x, y, text);
+}
+
+int fb_draw_text_scaled(t_framebuffer* fb, int x, int y, const char* text, int scale) {
+    switch (scale) {
+        case 2:
+            return draw_glyphs(fb, font_2x, x, y, text);
+        case 3:
+            return draw_glyphs(fb, font_3x, x, y, text);
+        default:
+            return draw_glyphs(fb, font_1x, x, y, text);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 128x64 monochrome frame in the SSD1306's own layout, so a page of it goes
+// to the panel as is: byte pixels[page][x] holds rows page*8 .. page*8+7 of
+// column x, least significant bit on top.
+#define FB_WIDTH            128
+#define FB_HEIGHT           64
+#define FB_PAGES            (FB_HEIGHT / 8)
+
+// Built-in 5x7 font on a 6 px pitch.
+#define FB_GLYPH_WIDTH      6
+#define FB_GLYPH_HEIGHT     8
+
+typedef struct {
+    uint8_t pixels[FB_PAGES][FB_WIDTH];
+} t_framebuffer;
+
+// Blanks the frame.
+void fb_clear(t_framebuffer* fb);
+
+// Everything below clips to the frame; coordinates may be off-screen.
+void fb_set_pixel(t_framebuffer* fb, int x, int y, bool on);
+void fb_fill_rect(t_framebuffer* fb, int x, int y, int w, int h, bool on);
+void fb_hline(t_framebuffer* fb, int x, int y, int w);
+void fb_vline(t_framebuffer* fb, int x, int y, int h);
+
+// Bresenham line from (x0, y0) to (x1, y1), both ends included. Pixel i of
+// the line is drawn if bit i % 8 of `pattern` is set: FB_LINE_SOLID, or
+// FB_LINE_DOTTED for every other pixel.
+#define FB_LINE_SOLID       0xFF
+#define FB_LINE_DOTTED      0x55
+void fb_line(t_framebuffer* fb, int x0, int y0, int x1, int y1, uint8_t pattern);
+
+// Vertical range for plotting values[0..n): their min and max, widened
+// around the middle to at least min_span so a flat series stays flat.
+void fb_series_range(const float* values, int n, float min_span, float* lo, float* hi);
+
+// Plots values[0..n) as a polyline spread across the box (x, y, w, h), lo on
+// its bottom row and hi on its top one. Segments ending at index dotted_from
+// or later are dotted; pass n for a solid line.
+void fb_plot_series(t_framebuffer* fb, int x, int y, int w, int h,
+                    const float* values, int n, float lo, float hi, int dotted_from);
+
+// Draws text with its top row at y, overwriting the 6x8 cell of each glyph.
+// Characters outside ' '..'z' draw as spaces. Returns the x after the last
+// glyph drawn; stops at the right edge. Fastest with y on a page boundary.
+int fb_draw_text(t_framebuffer* fb, int x, int y, const char* text);
+
+// The same at 2 or 3 times the size, in 12x16 or 18x24 cells. Only digits
+// and "+,-./" are scaled; anything else draws as a space.
+int fb_draw_text_scaled(t_framebuffer* fb, int x, int y, const char* text, int scale);
+
+// Width in pixels of text in the built-in font, and the x that centres it.
+// constexpr, so for a constant string the layout is done by the compiler.
+constexpr int fb_text_width(const char* text, int scale = 1) {
+    int len = 0;
+    while (text[len] != '\0') {
+        len++;
+    }
+    return len * FB_GLYPH_WIDTH * scale;
+}
+
+constexpr int fb_center_x(const char* text, int scale = 1) {
+    return (FB_WIDTH - fb_text_width(text, scale)) / 2;
+}
+
+#endif
@@ -0,0 +1,255 @@
+#include "gorilla_codec.h"
+#include <string.h>
+
+// Delta-of-delta buckets: prefix, then the value in two's complement.
+//   0                 dod == 0
+//   10   + 7 bits     -64 .. 63
+//   110  + 9 bits     -256 .. 255
+//   1110 + 12 bits    -2048 .. 2047
+//   1111 + 32 bits    anything else
+#define DOD_BITS_SHORT      7
+#define DOD_BITS_MEDIUM     9
+#define DOD_BITS_LONG       12
+
+#define NO_WINDOW           32
+
+static void write_bits(gorilla_encoder_t* enc, uint32_t value, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if ((value >> i) & 1u) {
+            enc->buf[enc->bit_pos >> 3] |= (uint8_t)(0x80u >> (enc->bit_pos & 7));
+        }
+        enc->bit_pos++;
+    }
+}
+
+static bool read_bits(gorilla_decoder_t* dec, int n, uint32_t* value) {
+    if (dec->bit_pos + n > dec->size * 8) {
+        return false;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t bit = (dec->buf[dec->bit_pos >> 3] >> (7 - (dec->bit_pos & 7))) & 1u;
+        v = (v << 1) | bit;
+        dec->bit_pos++;
+    }
+    *value = v;
+    return true;
+}
+
+static bool fits_signed(int32_t v, int bits) {
+    int32_t limit = 1 << (bits - 1);
+    return v >= -limit && v < limit;
+}
+
+static int32_t sign_extend(uint32_t v, int bits) {
+    uint32_t sign = 1u << (bits - 1);
+    return (int32_t)((v ^ sign) - sign);
+}
+
+static uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static void encode_timestamp(gorilla_encoder_t* enc, uint32_t timestamp) {
+    if (enc->count == 0) {
+        write_bits(enc, timestamp, 32);
+        enc->prev_ts = timestamp;
+        enc->prev_delta = 0;
+        return;
+    }
+
+    int32_t delta = (int32_t)(timestamp - enc->prev_ts);
+    int32_t dod = delta - enc->prev_delta;
+    if (dod == 0) {
+        write_bits(enc, 0x0, 1);
+    } else if (fits_signed(dod, DOD_BITS_SHORT)) {
+        write_bits(enc, 0x2, 2);
+        write_bits(enc, (uint32_t)dod & ((1u << DOD_BITS_SHORT) - 1), DOD_BITS_SHORT);
+    } else if (fits_signed(dod, DOD_BITS_MEDIUM)) {
+        write_bits(enc, 0x6, 3);
+        write_bits(enc, (uint32_t)dod & ((1u << DOD_BITS_MEDIUM) - 1), DOD_BITS_MEDIUM);
+    } else if (fits_signed(dod, DOD_BITS_LONG)) {
+        write_bits(enc, 0xE, 4);
+        write_bits(enc, (uint32_t)dod & ((1u << DOD_BITS_LONG) - 1), DOD_BITS_LONG);
+    } else {
+        write_bits(enc, 0xF, 4);
+        write_bits(enc, (uint32_t)dod, 32);
+    }
+    enc->prev_ts = timestamp;
+    enc->prev_delta = delta;
+}
+
+static bool decode_timestamp(gorilla_decoder_t* dec, uint32_t* timestamp) {
+    uint32_t v;
+    if (dec->index == 0) {
+        if (!read_bits(dec, 32, &v)) {
+            return false;
+        }
+        dec->prev_ts = v;
+        dec->prev_delta = 0;
+        *timestamp = v;
+        return true;
+    }
+
+    // Count the leading ones of the prefix, at most four.
+    int ones = 0;
+    while (ones < 4) {
+        if (!read_bits(dec, 1, &v)) {
+            return false;
+        }
+        if (v == 0) {
+            break;
+        }
+        ones++;
+    }
+
+    int32_t dod = 0;
+    static const int widths[] = { 0, DOD_BITS_SHORT, DOD_BITS_MEDIUM, DOD_BITS_LONG, 32 };
+    int width = widths[ones];
+    if (width > 0) {
+        if (!read_bits(dec, width, &v)) {
+            return false;
+        }
+        dod = width == 32 ? (int32_t)v : sign_extend(v, width);
+    }
+
+    dec->prev_delta += dod;
+    dec->prev_ts += (uint32_t)dec->prev_delta;
+    *timestamp = dec->prev_ts;
+    return true;
+}
+
+static void encode_value(gorilla_encoder_t* enc, gorilla_value_state_t* state, float value) {
+    uint32_t bits = float_bits(value);
+    if (enc->count == 0) {
+        write_bits(enc, bits, 32);
+        state->bits = bits;
+        state->leading = NO_WINDOW;
+        state->trailing = 0;
+        return;
+    }
+
+    uint32_t x = bits ^ state->bits;
+    state->bits = bits;
+    if (x == 0) {
+        write_bits(enc, 0x0, 1);
+        return;
+    }
+
+    int leading = __builtin_clz(x);
+    int trailing = __builtin_ctz(x);
+
+    if (state->leading != NO_WINDOW && leading >= state->leading && trailing >= state->trailing) {
+        // Fits the previous window: reuse its position.
+        write_bits(enc, 0x2, 2);
+        write_bits(enc, x >> state->trailing, 32 - state->leading - state->trailing);
+        return;
+    }
+
+    int meaningful = 32 - leading - trailing;
+    write_bits(enc, 0x3, 2);
+    write_bits(enc, (uint32_t)leading, 5);
+    write_bits(enc, (uint32_t)(meaningful - 1), 6);
+    write_bits(enc, x >> trailing, meaningful);
+    state->leading = (uint8_t)leading;
+    state->trailing = (uint8_t)trailing;
+}
+
+static bool decode_value(gorilla_decoder_t* dec, gorilla_value_state_t* state, float* value) {
+    uint32_t v;
+    if (dec->index == 0) {
+        if (!read_bits(dec, 32, &v)) {
+            return false;
+        }
+        state->bits = v;
+        state->leading = NO_WINDOW;
+        state->trailing = 0;
+        *value = bits_float(v);
+        return true;
+    }
+
+    if (!read_bits(dec, 1, &v)) {
+        return false;
+    }
+    if (v == 1) {
+        if (!read_bits(dec, 1, &v)) {
+            return false;
+        }
+        if (v == 1) {
+            uint32_t leading, meaningful;
+            if (!read_bits(dec, 5, &leading) || !read_bits(dec, 6, &meaningful)) {
+                return false;
+            }
+            meaningful += 1;
+            if (leading + meaningful > 32) {
+                return false;
+            }
+            state->leading = (uint8_t)leading;
+            state->trailing = (uint8_t)(32 - leading - meaningful);
+        } else if (state->leading == NO_WINDOW) {
+            return false;
+        }
+
+        uint32_t x;
+        if (!read_bits(dec, 32 - state->leading - state->trailing, &x)) {
+            return false;
+        }
+        state->bits ^= x << state->trailing;
+    }
+    *value = bits_float(state->bits);
+    return true;
+}
+
+void gorilla_encoder_init(gorilla_encoder_t* enc, uint8_t* buf, size_t capacity) {
+    memset(enc, 0, sizeof(*enc));
+    memset(buf, 0, capacity);
+    enc->buf = buf;
+    enc->capacity = capacity;
+}
+
+bool gorilla_encode(gorilla_encoder_t* enc, uint32_t timestamp, const t_bme280_s_val* value) {
+    if (enc->bit_pos + GORILLA_MAX_SAMPLE_BITS > enc->capacity * 8) {
+        return false;
+    }
+    encode_timestamp(enc, timestamp);
+    encode_value(enc, &enc->values[0], value->temperature);
+    encode_value(enc, &enc->values[1], value->humidity);
+    encode_value(enc, &enc->values[2], value->pressure);
+    enc->count++;
+    return true;
+}
+
+size_t gorilla_encoded_size(const gorilla_encoder_t* enc) {
+    return (enc->bit_pos + 7) / 8;
+}
+
+void gorilla_decoder_init(gorilla_decoder_t* dec, const uint8_t* buf, size_t size, uint32_t count) {
+    memset(dec, 0, sizeof(*dec));
+    dec->buf = buf;
+    dec->size = size;
+    dec->remaining = count;
+}
+
+bool gorilla_decode(gorilla_decoder_t* dec, uint32_t* timestamp, t_bme280_s_val* value) {
+    if (dec->remaining == 0) {
+        return false;
+    }
+    if (!decode_timestamp(dec, timestamp) ||
+        !decode_value(dec, &dec->values[0], &value->temperature) ||
+        !decode_value(dec, &dec->values[1], &value->humidity) ||
+        !decode_value(dec, &dec->values[2], &value->pressure)) {
+        dec->remaining = 0;
+        return false;
+    }
+    dec->index++;
+    dec->remaining--;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef GORILLA_CODEC_H
+#define GORILLA_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "data_structure.h"
+
+// Streaming compression for timestamped BME280 series, after Facebook's
+// Gorilla: timestamps as delta-of-delta in variable-width buckets, each of
+// the three features as the XOR with its previous value. Lossless, bit-level
+// append into a caller-supplied buffer, no heap.
+//
+// The stream carries no length; keep the sample count alongside it
+// (gorilla_encoder_t::count) and hand it to the decoder.
+
+#define GORILLA_FEATURES            3
+// Upper bound for one encoded sample: 4 + 32 timestamp bits, then
+// 2 + 5 + 6 + 32 per feature.
+#define GORILLA_MAX_SAMPLE_BITS     (36 + GORILLA_FEATURES * 45)
+
+typedef struct {
+    uint32_t bits;               // Previous value, as raw float bits
+    uint8_t  leading;            // Zero run of the current XOR window, 32 = none yet
+    uint8_t  trailing;
+} gorilla_value_state_t;
+
+typedef struct {
+    uint8_t* buf;
+    size_t   capacity;           // Bytes
+    size_t   bit_pos;
+    uint32_t count;
+    uint32_t prev_ts;
+    int32_t  prev_delta;
+    gorilla_value_state_t values[GORILLA_FEATURES];
+} gorilla_encoder_t;
+
+typedef struct {
+    const uint8_t* buf;
+    size_t   size;               // Bytes
+    size_t   bit_pos;
+    uint32_t remaining;
+    uint32_t index;
+    uint32_t prev_ts;
+    int32_t  prev_delta;
+    gorilla_value_state_t values[GORILLA_FEATURES];
+} gorilla_decoder_t;
+
+// Clears `buf` and starts an empty stream in it.
+void gorilla_encoder_init(gorilla_encoder_t* enc, uint8_t* buf, size_t capacity);
+
+// Appends one sample. Returns false, leaving the stream unchanged, if the
+// buffer might not hold it.
+bool gorilla_encode(gorilla_encoder_t* enc, uint32_t timestamp, const t_bme280_s_val* value);
+
+// Bytes used so far, including the partly filled last one.
+size_t gorilla_encoded_size(const gorilla_encoder_t* enc);
+
+void gorilla_decoder_init(gorilla_decoder_t* dec, const uint8_t* buf, size_t size, uint32_t count);
+
+// Reads the next sample. Returns false once `count` samples have been read
+// or if the stream ends early.
+bool gorilla_decode(gorilla_decoder_t* dec, uint32_t* timestamp, t_bme280_s_val* value);
+
+#endif
@@ -7,12 +7,15 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_timer.h"
+#include "esp_log.h"
 
 #include "model_data.h"
 #include "inference_data.h"
 #include "data_structure.h"
 #include "circle_buffer.h"
 
+#define TAG "[INFERENCE]"
+
  // tflite::MicroMutableOpResolver<13> resolver;
  // constexpr int scratchBufSize = 60 * 1024;
  // constexpr int kTensorArenaSize = 150 * 1024 + scratchBufSize;
@@ -35,57 +38,9 @@ namespace {
 
 t_infered prediction_result;
 
-void min_max_scaler(t_bme280_s_val* payload){
-  float min_temp = 22;
-  float min_humidity = 24;
-  float min_pressure = 1001.3;
-  float max_temp = 38;
-  float max_humidity = 100;
-  float max_pressure = 1013.9;
-  
-  bool clamped = false;
-  
-  payload->temperature = (payload->temperature - min_temp) / (max_temp - min_temp);
-  payload->humidity = (payload->humidity - min_humidity) / (max_humidity - min_humidity);
-  payload->pressure = (payload->pressure - min_pressure) / (max_pressure - min_pressure);
-
-  if(payload->temperature > 1) {
-    payload->temperature = 1;
-    clamped = true;
-    MicroPrintf("WARNING: Temperature clamped to max");
-  }
-  if(payload->temperature < 0) {
-    payload->temperature = 0;
-    clamped = true;
-    MicroPrintf("WARNING: Temperature clamped to min");
-  }
-
-  if(payload->humidity > 1) {
-    payload->humidity = 1;
-    clamped = true;
-    MicroPrintf("WARNING: Humidity clamped to max");
-  }
-  if(payload->humidity < 0) {
-    payload->humidity = 0;
-    clamped = true;
-    MicroPrintf("WARNING: Humidity clamped to min");
-  }
-
-  if(payload->pressure > 1) {
-    payload->pressure = 1;
-    clamped = true;
-    MicroPrintf("WARNING: Pressure clamped to max");
-  }
-  if(payload->pressure < 0) {
-    payload->pressure = 0;
-    clamped = true;
-    MicroPrintf("WARNING: Pressure clamped to min");
-  }
-  
-  if (clamped) {
-    MicroPrintf("Sensor values out of expected range - possible malfunction");
-  }
-}
+// Normalisation range the model was trained with.
+static const t_bme280_s_val feature_min = {22, 24, 1001.3f};
+static const t_bme280_s_val feature_max = {38, 100, 1013.9f};
 
 float inv_min_max(float scaled, float min, float max) {
   return scaled * (max - min) + min;
@@ -131,15 +86,45 @@ void init_interpeter(){
       model, resolver, tensor_arena, kTensorArenaSize);
   interpreter = &static_interpreter;
 
+  // The unrolled LSTM repeats the same few op params hundreds of times.
+  interpreter->SetCompactMetadata(true);
+  // Each unrolled step also runs MUL -> ADD and LOGISTIC/TANH -> MUL back to
+  // back; fusing them keeps those intermediates out of the arena.
+  interpreter->SetOperatorFusion(true);
+
   TfLiteStatus allocate_status = interpreter->AllocateTensors();
   if (allocate_status != kTfLiteOk) {
     MicroPrintf("AllocateTensors() failed");
     return;
   }
 
+  // Arena breakdown for tuning kTensorArenaSize; debug builds only, this runs
+  // on every full wake.
+  tflite::PersistentArenaUsage usage = interpreter->persistent_arena_usage();
+  ESP_LOGD(TAG, "Arena used %d bytes, persistent %d bytes",
+           (int)interpreter->arena_used_bytes(), (int)usage.total);
+  ESP_LOGD(TAG, "  eval tensors %d, nodes %d, builtin data %d (%d shared)",
+           (int)usage.eval_tensors, (int)usage.node_and_registrations,
+           (int)usage.builtin_data, (int)usage.shared_builtin_data);
+  ESP_LOGD(TAG, "  kernel buffers %d, tensors %d, scratch handles %d, other %d",
+           (int)usage.persistent_buffers, (int)usage.persistent_tensors,
+           (int)usage.scratch_handles, (int)usage.other);
+  ESP_LOGD(TAG, "Fused %d operator pairs", (int)interpreter->fused_operator_count());
+
   input = interpreter->input(0);
   output = interpreter->output(0);
 
+  // The sensor window is sized from kModelInputSteps at compile time, so a
+  // model with a different input shape must not be fed from it.
+  if (input->type != kTfLiteFloat32 || input->dims->size != 3 ||
+      input->dims->data[1] != kModelInputSteps ||
+      input->dims->data[2] != kModelInputFeatures) {
+    MicroPrintf("Model input shape doesn't match [1, %d, %d]",
+                kModelInputSteps, kModelInputFeatures);
+    interpreter = nullptr;
+    return;
+  }
+
   return;
 }
 
@@ -150,19 +135,17 @@ esp_err_t inference_invoke(){
     return ESP_FAIL;
   }
 
-  t_bme280_s_val sensor_data[24];
-  yield_data(sensor_data);
-
   TfLiteTensor* input = interpreter->input(0);
-  float* input_data = input->data.f;
-
-  for (int i = 0; i < 24; i++) {
-
-      min_max_scaler(&sensor_data[i]);
 
-      input_data[i * 3 + 0] = sensor_data[i].temperature;
-      input_data[i * 3 + 1] = sensor_data[i].humidity;
-      input_data[i * 3 + 2] = sensor_data[i].pressure;
+  // Decode the packed window straight into the tensor, already normalised.
+  static const t_feature_scaling scaling = make_feature_scaling(&feature_min, &feature_max);
+  int clamped = yield_window_scaled<kModelInputSteps, kModelInputFeatures>(input->data.f, &scaling);
+  if (clamped > 0) {
+    MicroPrintf("WARNING: %d input values clamped to [0, 1]", clamped);
+    MicroPrintf("Sensor values out of expected range - possible malfunction");
+  }
+  if (window_degraded()) {
+    MicroPrintf("WARNING: Input window restored across a gap, forecast degraded");
   }
 
   int64_t start_time = esp_timer_get_time();
@@ -176,10 +159,11 @@ esp_err_t inference_invoke(){
       MicroPrintf("Invoke done");
       prediction_result.time = (end_time - start_time);
       prediction_result.tensor_usage = interpreter->arena_used_bytes();
+      prediction_result.degraded = window_degraded();
+      prediction_result.valid = true;
   }
 
   TfLiteTensor* y = interpreter->output(0);
-  float* y_data = y->data.f;
 
   int steps = y->dims->data[1];
   int feats = y->dims->data[2];
@@ -188,18 +172,18 @@ esp_err_t inference_invoke(){
       for (int f = 0; f < feats; f++) {
 
           int index = t * feats + f;
-          float f_val = y_data[index];    
+          float f_val = y->data.f[index];
 
           if (f == 0){
-              f_val = inv_min_max(f_val, 22, 38);
+              f_val = inv_min_max(f_val, feature_min.temperature, feature_max.temperature);
               prediction_result.predicted_data[t].temperature = f_val;
           } 
           if (f == 1){
-              f_val = inv_min_max(f_val, 24, 100);
+              f_val = inv_min_max(f_val, feature_min.humidity, feature_max.humidity);
               prediction_result.predicted_data[t].humidity = f_val;
           } 
           if (f == 2){
-              f_val = inv_min_max(f_val, 1001.3, 1013.9);
+              f_val = inv_min_max(f_val, feature_min.pressure, feature_max.pressure);
               prediction_result.predicted_data[t].pressure = f_val;
           }
       }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_system.h"
 #include "nvs_flash.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -14,15 +15,38 @@
 #include "display_driver.h"
 #include "button_handler.h"
 #include "power_manager.h"
+#include "sensor_aggregate.h"
+#include "sensor_log.h"
+#include "anomaly_detector.h"
+#include "forecast_skill.h"
+#include "bias_correction.h"
+#include "model_selector.h"
+#include "esp_timer.h"
 
 #define TAG "MAIN"
 
 #define PASSWORD "REDACTED"
 #define SSID "REDACTED"
 
+// Samples are an inference interval apart, give or take the wake jitter, so
+// a backlog exists only once the gap to the last upload is clearly longer.
+#define BACKLOG_MIN_GAP_SECONDS (INFERENCE_INTERVAL_SECONDS * 3 / 2)
+
 static uint8_t current_page = 0;
 static bool network_status_displayed = false;
 static bool sleep_warning_displayed = false;
+// Timestamp of the newest sample known to have reached the broker.
+static RTC_DATA_ATTR uint32_t uploaded_until_ts = 0;
+
+// RTC memory survives a deep sleep wake only. After any other reset it is
+// reloaded from the image, so the state kept there starts over.
+static void reset_rtc_state(void) {
+    sensor_aggregate_reset();
+    anomaly_reset();
+    forecast_skill_reset();
+    bias_correction_reset();
+    model_selector_reset();
+}
 
 static esp_err_t system_init(void) {
     esp_err_t ret;
@@ -59,6 +83,9 @@ static esp_err_t system_init(void) {
         return ret;
     }
     
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        reset_rtc_state();
+    }
     init_circular_buffer();
     
     current_page = power_manager_get_display_page();
@@ -67,23 +94,49 @@ static esp_err_t system_init(void) {
     return ESP_OK;
 }
 
-static esp_err_t run_inference(t_infered* prediction) {
+// Off-schedule runs (anomaly alerts) leave the hourly inference time alone.
+static esp_err_t run_inference(t_infered* prediction, bool on_schedule) {
     ESP_LOGI(TAG, "=== Running Inference ===");
-    
-    init_interpeter();
-    vTaskDelay(pdMS_TO_TICKS(10));
-    
-    esp_err_t ret = inference_invoke();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Inference failed");
-        return ret;
+
+    uint32_t now = (uint32_t)(power_manager_get_time_ms() / 1000);
+    uint8_t model = on_schedule ? model_selector_choose(now, anomaly_alert_active(now)) : FORECASTER_FULL;
+    int64_t started = esp_timer_get_time();
+    esp_err_t ret;
+
+    if (model == FORECASTER_BASELINE) {
+        ret = baseline_forecast(prediction);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Baseline forecast failed");
+            return ret;
+        }
+        prediction->time = esp_timer_get_time() - started;
+    } else {
+        init_interpeter();
+        vTaskDelay(pdMS_TO_TICKS(10));
+
+        ret = inference_invoke();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Inference failed");
+            return ret;
+        }
+
+        *prediction = prediction_result;
+
+        // Learn from scheduled forecasts only: their steps line up with the
+        // hourly samples they are scored against.
+        if (on_schedule) {
+            bias_correction_record(now, prediction);
+        }
+        bias_correction_apply(prediction);
+    }
+    prediction->model = model;
+
+    if (on_schedule) {
+        model_selector_record_run(now, model, prediction, esp_timer_get_time() - started);
+        power_manager_update_inference_time();
     }
     
-    *prediction = prediction_result;
-    
-    power_manager_update_inference_time();
-    
-    ESP_LOGI(TAG, "Inference completed successfully");
+    ESP_LOGI(TAG, "Inference completed successfully (%s)", model_selector_name(model));
     ESP_LOGI(TAG, "Tensor usage: %d bytes", prediction->tensor_usage);
     ESP_LOGI(TAG, "Inference time: %lld us", prediction->time);
     
@@ -99,7 +152,7 @@ static void handle_network(t_bme280_s_val* sensor_data, t_infered* prediction, b
     init_mqtt();
     vTaskDelay(pdMS_TO_TICKS(500));
     
-    send_sensor_value(sensor_data, last_reset_code);
+    send_sensor_value(sensor_data, last_reset_code, NULL, 0);
     
     if (has_prediction) {
         expected_message = 2;
@@ -123,11 +176,49 @@ static void handle_network(t_bme280_s_val* sensor_data, t_infered* prediction, b
     vTaskDelay(pdMS_TO_TICKS(1000));
 }
 
+// Cheap wake between inferences: one reading into the hourly aggregate and
+// the anomaly detector, no display, Wi-Fi or model. Goes back to sleep unless
+// an anomaly alert calls for a forecast now, in which case it returns true.
+static bool take_subhourly_sample(void) {
+    initialize_i2c();
+
+    t_bme280_s_val reading = {0};
+    t_packed_sample packed;
+    read_sensor(&reading, &packed);
+    if (reading.temperature < 0) {
+        ESP_LOGW(TAG, "Sub-hourly sensor read failed, skipping sample");
+    } else {
+        sensor_aggregate_add(packed);
+        ESP_LOGI(TAG, "Sample %lu this hour: T=%.2f°C, H=%.2f%%, P=%.2fhPa",
+                 (unsigned long)sensor_aggregate_count(),
+                 reading.temperature, reading.humidity, reading.pressure);
+
+        uint32_t now = (uint32_t)(power_manager_get_time_ms() / 1000);
+        anomaly_update(now, &reading);
+        if (anomaly_alert_active(now)) {
+            ESP_LOGW(TAG, "Anomaly alert (0x%02x), running off-schedule forecast",
+                     anomaly_alert_flags(now));
+            return true;
+        }
+    }
+
+    power_manager_enter_deep_sleep_fast();
+    return false;
+}
+
 extern "C" void app_main() {
     ESP_LOGI(TAG, "\n\n========================================");
     ESP_LOGI(TAG, "Weather Prediction System Starting");
     ESP_LOGI(TAG, "========================================\n");
     
+    bool alert_run = false;
+    if (power_manager_is_sample_wake()) {
+        alert_run = take_subhourly_sample();
+        if (!alert_run) {
+            return;
+        }
+    }
+
     ESP_ERROR_CHECK(system_init());
     
     wake_cause_t wake_cause = power_manager_get_wake_cause();
@@ -140,6 +231,7 @@ extern "C" void app_main() {
     
     t_bme280_s_val sensor_data = {0};
     t_infered prediction = {0};
+    t_sensor_summary hourly = {0};
     esp_err_t inference_result = ESP_FAIL;
     bool skip_data_collection = false;
     bool wifi_connected = false;
@@ -153,14 +245,13 @@ extern "C" void app_main() {
         
         power_manager_get_data(&prediction, &sensor_data, &wifi_connected, ip_address);
         
-        if (size >= 24 && prediction.time == 0) {
-            ESP_LOGI(TAG, "Buffer full (24) but no valid prediction. Forcing inference...");
-            inference_result = run_inference(&prediction);
+        if (window_ready() && !prediction.valid) {
+            ESP_LOGI(TAG, "Buffer full (%d) but no valid prediction. Forcing inference...", kModelInputSteps);
+            inference_result = run_inference(&prediction, true);
             power_manager_save_data(&prediction, &sensor_data, wifi_connected, ip_address);
         }
         
-        // Assume inference is OK if we have valid saved data (simple check: time != 0)
-        if (prediction.time != 0) {
+        if (prediction.valid) {
             inference_result = ESP_OK;
             ESP_LOGI(TAG, "Loaded saved prediction from RTC");
         } else {
@@ -172,7 +263,8 @@ extern "C" void app_main() {
     }
     
     if (!skip_data_collection) {
-        read_sensor(&sensor_data);
+        t_packed_sample packed_data;
+        read_sensor(&sensor_data, &packed_data);
         vTaskDelay(pdMS_TO_TICKS(10));
         
         if (sensor_data.temperature < 0) {
@@ -185,18 +277,36 @@ extern "C" void app_main() {
         ESP_LOGI(TAG, "Sensor: T=%.1f°C, H=%.1f%%, P=%.0fhPa", 
                  sensor_data.temperature, sensor_data.humidity, sensor_data.pressure);
         
-        push_data_into_stack(sensor_data);
-        vTaskDelay(pdMS_TO_TICKS(10));
+        uint32_t sample_now = (uint32_t)(power_manager_get_time_ms() / 1000);
+        if (!alert_run) {
+            anomaly_update(sample_now, &sensor_data);
+
+            // The hour's readings go into the history as one averaged sample.
+            sensor_aggregate_add(packed_data);
+            sensor_aggregate_take(&hourly);
+            ESP_LOGI(TAG, "Hourly mean of %lu readings: T=%.2f°C, H=%.2f%%, P=%.2fhPa",
+                     (unsigned long)hourly.count,
+                     hourly.mean.temperature, hourly.mean.humidity, hourly.mean.pressure);
+
+            push_data_into_stack(hourly.packed_mean);
+            forecast_skill_observe(sample_now, &hourly.mean);
+            bias_correction_observe(sample_now, &hourly.mean);
+            model_selector_observe(sample_now, &hourly.mean);
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
         
-        bool should_infer = power_manager_should_run_inference();
-        bool inference_ready = (size >= 24);  // Need 24 data points
+        bool should_infer = alert_run || power_manager_should_run_inference();
+        bool inference_ready = window_ready();  // Need a full model window
         bool run_inference_now = should_infer && inference_ready;
         
         if (run_inference_now) {
-            inference_result = run_inference(&prediction);
+            inference_result = run_inference(&prediction, !alert_run);
+            if (inference_result == ESP_OK && !alert_run) {
+                forecast_skill_record(sample_now, &prediction);
+            }
         } else {
             if (!inference_ready) {
-                ESP_LOGI(TAG, "Not enough data for inference (%d/24)", size);
+                ESP_LOGI(TAG, "Not enough data for inference (%d/%d)", history_size(), kModelInputSteps);
             } else {
                 ESP_LOGI(TAG, "Inference not scheduled at this time");
             }
@@ -218,7 +328,16 @@ extern "C" void app_main() {
         init_mqtt();
         vTaskDelay(pdMS_TO_TICKS(500));
         
-        send_sensor_value(&sensor_data, last_reset_code);
+        uint8_t alerts = anomaly_alert_flags((uint32_t)(power_manager_get_time_ms() / 1000));
+        send_sensor_value(&sensor_data, last_reset_code, alert_run ? NULL : &hourly, alerts);
+
+        // Hours logged while the uplink was down go up as one compressed batch.
+        // Right after a good upload nothing lies in between, so skip the seek.
+        uint32_t sample_ts = sensor_log_newest_timestamp();
+        int backlog = 0;
+        if (uploaded_until_ts != 0 && uploaded_until_ts + BACKLOG_MIN_GAP_SECONDS < sample_ts) {
+            backlog = send_sensor_batch(uploaded_until_ts + 1, sample_ts - 1);
+        }
         
         if (inference_result == ESP_OK) {
             expected_message = 2;
@@ -226,6 +345,16 @@ extern "C" void app_main() {
         } else {
             expected_message = 1;
         }
+        if (backlog > 0) {
+            expected_message++;
+        }
+        t_skill_summary skill[SKILL_MODELS];
+        bool skill_sent = false;
+        if (!alert_run && forecast_skill_pending_report(skill)) {
+            send_skill_metrics(skill);
+            expected_message++;
+            skill_sent = true;
+        }
         
         TickType_t wait_time = pdMS_TO_TICKS(10000);
         while (sent_message < expected_message && wait_time > 0) {
@@ -235,6 +364,10 @@ extern "C" void app_main() {
         
         if (sent_message >= expected_message) {
             ESP_LOGI(TAG, "All data sent successfully");
+            uploaded_until_ts = sample_ts;
+            if (skill_sent) {
+                forecast_skill_ack_report();
+            }
         } else {
             ESP_LOGW(TAG, "MQTT send timeout");
         }
@@ -250,7 +383,9 @@ extern "C" void app_main() {
 
         power_manager_save_data(&prediction, &sensor_data, wifi_connected, ip_address);
         
-        power_manager_update_inference_time();
+        if (!alert_run) {
+            power_manager_update_inference_time();
+        }
         
         ESP_LOGI(TAG, "Inference completed successfully");
         ESP_LOGI(TAG, "Tensor usage: %d bytes", prediction.tensor_usage);
@@ -258,13 +393,16 @@ extern "C" void app_main() {
     
     ESP_LOGI(TAG, "=== Entering Interactive Mode ===");
     
+    if (inference_result == ESP_OK) {
+        display_prerender(&prediction, &sensor_data, wifi_connected, ip_address, history_size(), kModelInputSteps);
+    }
     display_on();
     vTaskDelay(pdMS_TO_TICKS(100));
     
     if (inference_result == ESP_OK) {
         display_show_page(current_page, &prediction, &sensor_data);
     } else {
-        display_show_network_status(wifi_connected, ip_address, size);
+        display_show_network_status(wifi_connected, ip_address, history_size(), kModelInputSteps);
     }
     
     button_reset_inactivity_timer();
@@ -278,7 +416,7 @@ extern "C" void app_main() {
             case BTN_EVENT_NEXT_PRESSED:
                 // Next page
                 current_page++;
-                if (current_page > DISPLAY_PAGE_MAX) {
+                if (current_page > DISPLAY_PAGE_LAST) {
                     current_page = 0;
                 }
                 display_show_page(current_page, &prediction, &sensor_data);
@@ -288,7 +426,7 @@ extern "C" void app_main() {
                 
             case BTN_EVENT_PREV_PRESSED:
                 if (current_page == 0) {
-                    current_page = DISPLAY_PAGE_MAX;
+                    current_page = DISPLAY_PAGE_LAST;
                 } else {
                     current_page--;
                 }
@@ -298,7 +436,7 @@ extern "C" void app_main() {
                 break;
                 
             case BTN_EVENT_BOTH_PRESSED:
-                display_show_network_status(wifi_connected, ip_address, size);
+                display_show_network_status(wifi_connected, ip_address, history_size(), kModelInputSteps);
                 network_status_displayed = true;
                 sleep_warning_displayed = false;
                 break;
@@ -4,4 +4,10 @@
 extern const unsigned char i8Quantized_tflite[];
 extern const unsigned int i8Quantized_tflite_len;
 
-#endif
\ No newline at end of file
+// Input shape of i8Quantized_tflite, [1, steps, features]. The sensor window
+// is sized from these at compile time; init_interpeter() checks them against
+// the model itself.
+constexpr int kModelInputSteps = 24;
+constexpr int kModelInputFeatures = 3;
+
+#endif
@@ -0,0 +1,187 @@
+#include "model_selector.h"
+#include "circle_buffer.h"
+#include "forecast_skill.h"
+#include "packed_sample.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+#define TAG "[SELECTOR]"
+
+#define FORECASTERS             2
+#define MIN_SCORES              6
+
+// Width of the training range per variable, so the three errors can be
+// summed on one scale.
+static const float error_scale[3] = { 16.0f, 76.0f, 12.6f };
+
+typedef struct {
+    uint8_t  baseline_runs;              // In a row
+    uint16_t scores[FORECASTERS];
+    float    error[FORECASTERS];         // EWMA of the normalised 1 h error
+    float    cost_ms[FORECASTERS];       // EWMA of the run time
+    uint32_t step_ts[FORECASTERS];       // Issue time of the pending 1 h step, 0 = none
+    t_packed_sample step[FORECASTERS];
+    float    budget_ms;
+    uint32_t budget_ts;
+    uint32_t saved_ms;
+} t_selector_state;
+
+static RTC_DATA_ATTR t_selector_state state;
+
+static void ewma(float* value, float x, bool first) {
+    *value = first ? x : *value + SELECTOR_ERROR_ALPHA * (x - *value);
+}
+
+static void refill_budget(uint32_t now) {
+    if (state.budget_ts != 0 && now > state.budget_ts) {
+        state.budget_ms += (float)(now - state.budget_ts) * SELECTOR_FULL_BUDGET_MS_PER_DAY / 86400.0f;
+        if (state.budget_ms > SELECTOR_FULL_BUDGET_MS_PER_DAY) {
+            state.budget_ms = SELECTOR_FULL_BUDGET_MS_PER_DAY;
+        }
+    }
+    state.budget_ts = now;
+}
+
+// Largest hour-to-hour step over the last BASELINE_TREND_HOURS.
+static bool weather_steady(void) {
+    t_bme280_s_val recent[BASELINE_TREND_HOURS + 1];
+    int n = history_size() < BASELINE_TREND_HOURS + 1 ? history_size() : BASELINE_TREND_HOURS + 1;
+    n = yield_history(recent, n);
+    for (int i = 1; i < n; i++) {
+        if (fabsf(recent[i].pressure - recent[i - 1].pressure) > SELECTOR_STEADY_PRESSURE ||
+            fabsf(recent[i].temperature - recent[i - 1].temperature) > SELECTOR_STEADY_TEMPERATURE) {
+            return false;
+        }
+    }
+    return n > 1;
+}
+
+static float trend(const float* y, int n) {
+    if (n < 2) {
+        return 0.0f;
+    }
+    float mean_x = (n - 1) / 2.0f;
+    float mean_y = 0.0f;
+    for (int i = 0; i < n; i++) {
+        mean_y += y[i];
+    }
+    mean_y /= n;
+    float sxy = 0.0f, sxx = 0.0f;
+    for (int i = 0; i < n; i++) {
+        sxy += (i - mean_x) * (y[i] - mean_y);
+        sxx += (i - mean_x) * (i - mean_x);
+    }
+    return sxy / sxx;
+}
+
+void model_selector_reset(void) {
+    memset(&state, 0, sizeof(state));
+    state.budget_ms = SELECTOR_FULL_BUDGET_MS_PER_DAY;
+}
+
+esp_err_t baseline_forecast(t_infered* forecast) {
+    t_bme280_s_val recent[BASELINE_TREND_HOURS + 1];
+    int n = history_size() < BASELINE_TREND_HOURS + 1 ? history_size() : BASELINE_TREND_HOURS + 1;
+    n = yield_history(recent, n);
+    if (n == 0) {
+        return ESP_FAIL;
+    }
+
+    float series[3][BASELINE_TREND_HOURS + 1];
+    for (int i = 0; i < n; i++) {
+        series[0][i] = recent[i].temperature;
+        series[1][i] = recent[i].humidity;
+        series[2][i] = recent[i].pressure;
+    }
+    float slope[3] = { trend(series[0], n), trend(series[1], n), trend(series[2], n) };
+    const t_bme280_s_val* last = &recent[n - 1];
+
+    memset(forecast, 0, sizeof(*forecast));
+    float damped = 0.0f, weight = 1.0f;
+    for (int h = 0; h < 6; h++) {
+        weight *= BASELINE_DAMPING;
+        damped += weight;
+        forecast->predicted_data[h].temperature = last->temperature + slope[0] * damped;
+        forecast->predicted_data[h].humidity = last->humidity + slope[1] * damped;
+        forecast->predicted_data[h].pressure = last->pressure + slope[2] * damped;
+    }
+    forecast->degraded = window_degraded();
+    forecast->valid = true;
+    return ESP_OK;
+}
+
+uint8_t model_selector_choose(uint32_t now, bool alert) {
+    refill_budget(now);
+
+    t_infered shadow;
+    if (baseline_forecast(&shadow) == ESP_OK) {
+        state.step[FORECASTER_BASELINE] = pack_sample(&shadow.predicted_data[0]);
+        state.step_ts[FORECASTER_BASELINE] = now;
+    }
+
+    if (alert || window_degraded()) {
+        ESP_LOGI(TAG, "Full model: alert or degraded window");
+        return FORECASTER_FULL;
+    }
+    if (state.cost_ms[FORECASTER_FULL] > 0.0f && state.budget_ms < state.cost_ms[FORECASTER_FULL]) {
+        ESP_LOGI(TAG, "Baseline: budget spent (%.0f ms left)", state.budget_ms);
+        return FORECASTER_BASELINE;
+    }
+    if (state.baseline_runs >= SELECTOR_MAX_BASELINE_RUNS) {
+        ESP_LOGI(TAG, "Full model: refreshing its score");
+        return FORECASTER_FULL;
+    }
+    bool scored = state.scores[FORECASTER_FULL] >= MIN_SCORES && state.scores[FORECASTER_BASELINE] >= MIN_SCORES;
+    if (scored && weather_steady() &&
+        state.error[FORECASTER_BASELINE] <= state.error[FORECASTER_FULL] * SELECTOR_ERROR_MARGIN) {
+        ESP_LOGI(TAG, "Baseline: steady weather, error %.4f vs full %.4f",
+                 state.error[FORECASTER_BASELINE], state.error[FORECASTER_FULL]);
+        return FORECASTER_BASELINE;
+    }
+    return FORECASTER_FULL;
+}
+
+void model_selector_record_run(uint32_t now, uint8_t model, const t_infered* forecast, int64_t elapsed_us) {
+    float ms = elapsed_us / 1000.0f;
+    ewma(&state.cost_ms[model], ms, state.cost_ms[model] == 0.0f);
+
+    if (model == FORECASTER_FULL) {
+        state.budget_ms -= ms;
+        state.baseline_runs = 0;
+        state.step[FORECASTER_FULL] = pack_sample(&forecast->predicted_data[0]);
+        state.step_ts[FORECASTER_FULL] = now;
+    } else {
+        state.baseline_runs++;
+        state.step_ts[FORECASTER_FULL] = 0;
+        if (state.cost_ms[FORECASTER_FULL] > ms) {
+            state.saved_ms += (uint32_t)(state.cost_ms[FORECASTER_FULL] - ms);
+        }
+    }
+}
+
+void model_selector_observe(uint32_t timestamp, const t_bme280_s_val* observed) {
+    for (int m = 0; m < FORECASTERS; m++) {
+        if (forecast_horizon(state.step_ts[m], timestamp) != 1) {
+            continue;
+        }
+        t_bme280_s_val p = unpack_sample(state.step[m]);
+        float error = (fabsf(p.temperature - observed->temperature) / error_scale[0] +
+                       fabsf(p.humidity - observed->humidity) / error_scale[1] +
+                       fabsf(p.pressure - observed->pressure) / error_scale[2]) / 3.0f;
+        ewma(&state.error[m], error, state.scores[m] == 0);
+        if (state.scores[m] < UINT16_MAX) {
+            state.scores[m]++;
+        }
+        state.step_ts[m] = 0;
+    }
+}
+
+uint32_t model_selector_saved_ms(void) {
+    return state.saved_ms;
+}
+
+const char* model_selector_name(uint8_t model) {
+    return model == FORECASTER_BASELINE ? "baseline" : "full";
+}
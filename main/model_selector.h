@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef MODEL_SELECTOR_H
+#define MODEL_SELECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "data_structure.h"
+
+// Chooses, for each scheduled forecast, between the full LSTM and a
+// damped-trend persistence baseline computed from the RTC history.
+//
+// Both are scored on their 1 h step against the next hourly sample (the
+// baseline is always computed, so it is shadow-scored even when the full
+// model runs). The baseline is used when the weather is steady and it has
+// recently been about as good as the full model, or when the inference
+// time budget is spent. Alerts and degraded windows always get the full
+// model, and it runs at least every SELECTOR_MAX_BASELINE_RUNS hours to keep
+// its score current.
+
+#define FORECASTER_FULL                 0
+#define FORECASTER_BASELINE             1
+
+#define BASELINE_TREND_HOURS            3
+#define BASELINE_DAMPING                0.8f
+
+#define SELECTOR_ERROR_ALPHA            0.1f    // EWMA weight of a new score
+#define SELECTOR_ERROR_MARGIN           1.1f    // Baseline may be 10% worse
+#define SELECTOR_STEADY_PRESSURE        0.3f    // hPa/h, max hourly step
+#define SELECTOR_STEADY_TEMPERATURE     1.5f    // degC/h, max hourly step
+#define SELECTOR_MAX_BASELINE_RUNS      6
+// Wake time the full model may spend per day. Unspent time carries over up
+// to one day's worth.
+#define SELECTOR_FULL_BUDGET_MS_PER_DAY 12000
+
+// Forgets scores, costs and the budget (cold boot).
+void model_selector_reset(void);
+
+// Fills `forecast` with the damped-trend baseline.
+esp_err_t baseline_forecast(t_infered* forecast);
+
+// Picks the forecaster for a scheduled run at `now` (seconds), and shadows
+// the baseline for scoring.
+uint8_t model_selector_choose(uint32_t now, bool alert);
+
+// Records the outcome of a run: which model, its forecast and how long it
+// took, in microseconds.
+void model_selector_record_run(uint32_t now, uint8_t model, const t_infered* forecast, int64_t elapsed_us);
+
+// Scores the 1 h steps due at `timestamp` against `observed`.
+void model_selector_observe(uint32_t timestamp, const t_bme280_s_val* observed);
+
+// Wake time the baseline runs have saved so far, in milliseconds.
+uint32_t model_selector_saved_ms(void);
+
+const char* model_selector_name(uint8_t model);
+
+#endif
@@ -4,6 +4,12 @@
 #include "esp_log.h"
 #include "mqtt_client.h"
 #include "data_structure.h"
+#include "gorilla_codec.h"
+#include "sensor_log.h"
+#include "model_selector.h"
+#include "power_manager.h"
+#include "bme280_driver.h"
+#include "display_driver.h"
 
 #define TAG "MQTT"
 
@@ -72,7 +78,31 @@ void init_mqtt(){
     esp_mqtt_client_start(client);
 }
 
-void send_sensor_value(t_bme280_s_val* payload, int status_code){
+static void add_feature_stats(cJSON* parent, const char* name, float mean, float min, float max, float variance) {
+    cJSON* stats = cJSON_AddObjectToObject(parent, name);
+    cJSON_AddNumberToObject(stats, "Mean", mean);
+    cJSON_AddNumberToObject(stats, "Min", min);
+    cJSON_AddNumberToObject(stats, "Max", max);
+    cJSON_AddNumberToObject(stats, "Variance", variance);
+}
+
+// Bus traffic of one device since this wake's boot. Skipped for devices that
+// were not created on this wake.
+static void add_i2c_stats(cJSON* parent, const char* name, i2c_bus_device_handle_t device) {
+    i2c_bus_device_stats_t stats;
+    if (device == NULL || i2c_bus_device_get_stats(device, &stats) != ESP_OK) {
+        return;
+    }
+    cJSON* entry = cJSON_AddObjectToObject(parent, name);
+    cJSON_AddNumberToObject(entry, "Transactions", stats.transactions);
+    cJSON_AddNumberToObject(entry, "Errors", stats.errors);
+    cJSON_AddNumberToObject(entry, "Bytes", stats.bytes);
+    cJSON_AddNumberToObject(entry, "ClockSwitches", stats.clk_switches);
+    cJSON_AddNumberToObject(entry, "BusUs", stats.bus_us);
+    cJSON_AddNumberToObject(entry, "WaitUs", stats.wait_us);
+}
+
+void send_sensor_value(t_bme280_s_val* payload, int status_code, const t_sensor_summary* hourly, uint8_t alerts){
     if (client == NULL) {
         ESP_LOGE(TAG, "MQTT client not initialized, cannot send sensor value");
         return;
@@ -83,6 +113,28 @@ void send_sensor_value(t_bme280_s_val* payload, int status_code){
     cJSON_AddNumberToObject(json, "Humidity", payload -> humidity);
     cJSON_AddNumberToObject(json, "Pressure", payload -> pressure);
     cJSON_AddNumberToObject(json, "Health", status_code);
+    if (alerts != 0) {
+        cJSON_AddNumberToObject(json, "Alert", alerts);
+    }
+
+    if (hourly != NULL && hourly->count > 0) {
+        cJSON* aggregate = cJSON_AddObjectToObject(json, "Hourly");
+        cJSON_AddNumberToObject(aggregate, "Samples", hourly->count);
+        add_feature_stats(aggregate, "Temperature", hourly->mean.temperature, hourly->min.temperature,
+                          hourly->max.temperature, hourly->variance.temperature);
+        add_feature_stats(aggregate, "Humidity", hourly->mean.humidity, hourly->min.humidity,
+                          hourly->max.humidity, hourly->variance.humidity);
+        add_feature_stats(aggregate, "Pressure", hourly->mean.pressure, hourly->min.pressure,
+                          hourly->max.pressure, hourly->variance.pressure);
+    }
+
+    cJSON* wake = cJSON_AddObjectToObject(json, "WakeMs");
+    cJSON_AddNumberToObject(wake, "Sample", power_manager_last_wake_ms(true));
+    cJSON_AddNumberToObject(wake, "Full", power_manager_last_wake_ms(false));
+
+    cJSON* i2c = cJSON_AddObjectToObject(json, "I2c");
+    add_i2c_stats(i2c, "Sensor", get_sensor_i2c_device());
+    add_i2c_stats(i2c, "Display", get_display_i2c_device());
 
 
     char* json_string = cJSON_PrintUnformatted(json);
@@ -107,6 +159,9 @@ void send_inference_value(t_infered* payload){
     cJSON_AddNumberToObject(json, "tensor_arena", payload -> tensor_usage);
 
     cJSON_AddNumberToObject(json, "time", payload -> time);
+    cJSON_AddBoolToObject(json, "degraded", payload -> degraded);
+    cJSON_AddStringToObject(json, "model", model_selector_name(payload -> model));
+    cJSON_AddNumberToObject(json, "saved_ms", model_selector_saved_ms());
     cJSON* pred_temperature = cJSON_AddArrayToObject(json, "pred_temp");
     cJSON* pred_humidity = cJSON_AddArrayToObject(json, "pred_humidity");
     cJSON* pred_pressure = cJSON_AddArrayToObject(json, "pred_pressure");
@@ -130,3 +185,92 @@ void send_inference_value(t_infered* payload){
 }
 
 
+
+int send_sensor_batch(uint32_t from_ts, uint32_t to_ts){
+    if (client == NULL) {
+        ESP_LOGE(TAG, "MQTT client not initialized, cannot send sensor batch");
+        return 0;
+    }
+    if (from_ts > to_ts) {
+        return 0;
+    }
+
+    // Older hours are dropped rather than the newest, so start late enough
+    // for the newest to fit.
+    uint32_t max_hours = SENSOR_BATCH_BYTES * 8 / GORILLA_MAX_SAMPLE_BITS;
+    if (to_ts - from_ts >= max_hours * 3600) {
+        from_ts = to_ts - max_hours * 3600 + 1;
+    }
+
+    sensor_log_cursor_t cursor;
+    if (sensor_log_seek(&cursor, from_ts, to_ts) != ESP_OK) {
+        return 0;
+    }
+
+    static uint8_t batch[2 + SENSOR_BATCH_BYTES];
+    gorilla_encoder_t encoder;
+    gorilla_encoder_init(&encoder, batch + 2, SENSOR_BATCH_BYTES);
+
+    sensor_log_sample_t sample;
+    while (sensor_log_next(&cursor, &sample)) {
+        if (!gorilla_encode(&encoder, sample.timestamp, &sample.value)) {
+            break;
+        }
+    }
+    if (encoder.count == 0) {
+        return 0;
+    }
+
+    batch[0] = (uint8_t)(encoder.count & 0xFF);
+    batch[1] = (uint8_t)(encoder.count >> 8);
+    int len = 2 + (int)gorilla_encoded_size(&encoder);
+    esp_mqtt_client_publish(client, "/sensor/batch", (const char*)batch, len, 1, 0);
+
+    ESP_LOGI(TAG, "Sensor batch: %lu samples in %d bytes",
+             (unsigned long)encoder.count, len);
+    return (int)encoder.count;
+}
+
+static void add_horizon_metric(cJSON* parent, const char* name, const t_bme280_s_val values[]) {
+    cJSON* metric = cJSON_AddObjectToObject(parent, name);
+    cJSON* temperature = cJSON_AddArrayToObject(metric, "temp");
+    cJSON* humidity = cJSON_AddArrayToObject(metric, "humidity");
+    cJSON* pressure = cJSON_AddArrayToObject(metric, "pressure");
+    for (int h = 0; h < SKILL_HORIZONS; h++) {
+        cJSON_AddItemToArray(temperature, cJSON_CreateNumber(values[h].temperature));
+        cJSON_AddItemToArray(humidity, cJSON_CreateNumber(values[h].humidity));
+        cJSON_AddItemToArray(pressure, cJSON_CreateNumber(values[h].pressure));
+    }
+}
+
+void send_skill_metrics(const t_skill_summary summaries[SKILL_MODELS]){
+    if (client == NULL) {
+        ESP_LOGE(TAG, "MQTT client not initialized, cannot send skill metrics");
+        return;
+    }
+
+    // One object per forecaster, keyed "full" and "baseline".
+    json = cJSON_CreateObject();
+    for (uint8_t m = 0; m < SKILL_MODELS; m++) {
+        const t_skill_summary* summary = &summaries[m];
+        cJSON* model = cJSON_AddObjectToObject(json, model_selector_name(m));
+        cJSON* count = cJSON_AddArrayToObject(model, "count");
+        for (int h = 0; h < SKILL_HORIZONS; h++) {
+            cJSON_AddItemToArray(count, cJSON_CreateNumber(summary->count[h]));
+        }
+        add_horizon_metric(model, "mae", summary->mae);
+        add_horizon_metric(model, "rmse", summary->rmse);
+        add_horizon_metric(model, "bias", summary->bias);
+    }
+
+    char* json_string = cJSON_PrintUnformatted(json);
+
+    if(json_string){
+        esp_mqtt_client_publish(client, "/metrics", json_string, 0, 1, 0);
+    }else{
+        ESP_LOGE(TAG, "Failed to Create JSON String");
+    }
+
+    cJSON_Delete(json);
+    free(json_string);
+}
@@ -2,6 +2,8 @@
 #define SEND_MQTT_H_
 
     #include "data_structure.h"
+    #include "sensor_aggregate.h"
+    #include "forecast_skill.h"
     #include "mqtt_client.h"
     
     extern esp_mqtt_client_handle_t client;
@@ -11,8 +13,22 @@
     void init_mqtt();
     void log_error_if_nonzero(const char *message, int error_code);
     void mqtt_event_handler(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data);
-    void send_sensor_value(t_bme280_s_val* payload, int status_code);
+    // `hourly` adds the aggregate of the readings behind this hour's sample;
+    // pass NULL to publish the instantaneous reading only. Non-zero `alerts`
+    // (ANOMALY_* flags) are published as "Alert".
+    void send_sensor_value(t_bme280_s_val* payload, int status_code, const t_sensor_summary* hourly, uint8_t alerts);
     void send_inference_value(t_infered* payload);
 
+    // Publishes the logged samples with from_ts <= timestamp <= to_ts to
+    // /sensor/batch as one Gorilla stream (gorilla_codec.h), prefixed with
+    // the sample count as a little-endian uint16. At most the newest
+    // SENSOR_BATCH_BYTES worth are sent. Returns the number of samples
+    // published, 0 if there were none.
+    #define SENSOR_BATCH_BYTES 2048
+    int send_sensor_batch(uint32_t from_ts, uint32_t to_ts);
+
+    // Publishes per-horizon forecast skill to /metrics.
+    void send_skill_metrics(const t_skill_summary summaries[SKILL_MODELS]);
+
 #endif
 
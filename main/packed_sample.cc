@@ -0,0 +1,58 @@
+#include "packed_sample.h"
+#include <math.h>
+
+static int32_t clamp_i32(int32_t v, int32_t lo, int32_t hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static int32_t quantize(float value, float lsb, int32_t lo, int32_t hi) {
+    return clamp_i32((int32_t)lroundf(value / lsb), lo, hi);
+}
+
+t_packed_sample pack_sample(const t_bme280_s_val* value) {
+    t_packed_sample packed;
+    packed.temperature = (int16_t)quantize(value->temperature, PACKED_TEMPERATURE_LSB, INT16_MIN, INT16_MAX);
+    packed.humidity = (uint16_t)quantize(value->humidity, PACKED_HUMIDITY_LSB, 0, UINT16_MAX);
+    packed.pressure = (uint16_t)quantize(value->pressure - PACKED_PRESSURE_BASE, PACKED_PRESSURE_LSB, 0, UINT16_MAX);
+    return packed;
+}
+
+// The packed LSBs in the BME280's fixed-point units.
+#define FIXED_PRESSURE_LSB_SHIFT    9           // 2 Pa = 512 in Q24.8
+#define FIXED_PRESSURE_BASE         (30000 << 8)  // 300 hPa in Q24.8 Pa
+#define FIXED_HUMIDITY_SHIFT        10          // Q22.10
+
+static_assert(PACKED_TEMPERATURE_LSB == 0.01f && PACKED_HUMIDITY_LSB == 0.01f &&
+              PACKED_PRESSURE_LSB == 0.02f && PACKED_PRESSURE_BASE == 300.0f,
+              "pack_sample_fixed() hard-codes the packed LSBs");
+
+t_packed_sample pack_sample_fixed(int32_t temperature, uint32_t pressure, uint32_t humidity) {
+    int32_t rh = (int32_t)(((uint64_t)humidity * 100 + (1u << (FIXED_HUMIDITY_SHIFT - 1))) >> FIXED_HUMIDITY_SHIFT);
+    int64_t pa = ((int64_t)pressure - FIXED_PRESSURE_BASE + (1 << (FIXED_PRESSURE_LSB_SHIFT - 1))) >> FIXED_PRESSURE_LSB_SHIFT;
+
+    t_packed_sample packed;
+    packed.temperature = (int16_t)clamp_i32(temperature, INT16_MIN, INT16_MAX);
+    packed.humidity = (uint16_t)clamp_i32(rh, 0, UINT16_MAX);
+    packed.pressure = (uint16_t)(pa < 0 ? 0 : (pa > UINT16_MAX ? UINT16_MAX : pa));
+    return packed;
+}
+
+t_bme280_s_val unpack_sample(t_packed_sample packed) {
+    t_bme280_s_val value;
+    value.temperature = packed.temperature * PACKED_TEMPERATURE_LSB;
+    value.humidity = packed.humidity * PACKED_HUMIDITY_LSB;
+    value.pressure = PACKED_PRESSURE_BASE + packed.pressure * PACKED_PRESSURE_LSB;
+    return value;
+}
+
+static int32_t lerp_lsb(int32_t from, int32_t to, int step, int steps) {
+    return from + (int32_t)lroundf((float)(to - from) * step / steps);
+}
+
+t_packed_sample interpolate_sample(t_packed_sample from, t_packed_sample to, int step, int steps) {
+    t_packed_sample packed;
+    packed.temperature = (int16_t)lerp_lsb(from.temperature, to.temperature, step, steps);
+    packed.humidity = (uint16_t)lerp_lsb(from.humidity, to.humidity, step, steps);
+    packed.pressure = (uint16_t)lerp_lsb(from.pressure, to.pressure, step, steps);
+    return packed;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef PACKED_SAMPLE_H
+#define PACKED_SAMPLE_H
+
+#include <stdint.h>
+#include "data_structure.h"
+
+// Fixed-point storage format for one BME280 reading, shared by the RTC
+// history and the flash log. 6 bytes instead of three floats.
+#define PACKED_TEMPERATURE_LSB      0.01f       // degC
+#define PACKED_HUMIDITY_LSB         0.01f       // %RH
+#define PACKED_PRESSURE_LSB         0.02f       // hPa
+#define PACKED_PRESSURE_BASE        300.0f      // hPa, BME280 lower limit
+
+typedef struct __attribute__((packed)) {
+    int16_t  temperature;
+    uint16_t humidity;
+    uint16_t pressure;               // Offset from PACKED_PRESSURE_BASE
+} t_packed_sample;
+
+// Rounds to the nearest LSB and saturates at the format limits.
+t_packed_sample pack_sample(const t_bme280_s_val* value);
+t_bme280_s_val unpack_sample(t_packed_sample packed);
+
+// Same format straight from the BME280's integer compensation: temperature
+// in 0.01 degC, pressure in Pa Q24.8, humidity in %RH Q22.10. No float on
+// this path; rounds to nearest and saturates like pack_sample().
+t_packed_sample pack_sample_fixed(int32_t temperature, uint32_t pressure, uint32_t humidity);
+
+// Point `step` of `steps` on the straight line from `from` to `to`, in LSBs,
+// rounded to the nearest one.
+t_packed_sample interpolate_sample(t_packed_sample from, t_packed_sample to, int step, int steps);
+
+#endif
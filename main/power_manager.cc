@@ -5,6 +5,8 @@
 #include "driver/gpio.h"
 #include "driver/rtc_io.h" 
 #include "button_handler.h"
+#include "anomaly_detector.h"
+#include "display_driver.h"
 #include <sys/time.h>
 #include <time.h>
 #include "freertos/FreeRTOS.h"
@@ -85,12 +87,27 @@ uint64_t power_manager_calculate_sleep_duration(void) {
     }
     
     int64_t remaining_ms = pm_state.next_inference_time_ms - current_time_ms;
+    pm_state.sample_wake = false;
     
     if (remaining_ms <= 0) {
         ESP_LOGI(TAG, "Inference overdue by %lld ms, sleeping briefly to reset", -remaining_ms);
         return 1000000ULL; 
     }
-    
+
+    // Only stop for a sample if it leaves at least half an interval before
+    // the inference, so the last one isn't taken seconds before the hourly read.
+    int sample_minutes = anomaly_alert_active((uint32_t)(current_time_ms / 1000))
+                         ? ANOMALY_ALERT_SAMPLE_MINUTES : SUBHOUR_SAMPLE_MINUTES;
+    if (sample_minutes > 0) {
+        const int64_t sample_interval_ms = sample_minutes * 60 * 1000LL;
+        if (remaining_ms > sample_interval_ms + sample_interval_ms / 2) {
+            pm_state.sample_wake = true;
+            ESP_LOGI(TAG, "Sampling in %d minutes, inference in %lld seconds",
+                     sample_minutes, remaining_ms / 1000);
+            return (uint64_t)sample_interval_ms * 1000ULL;
+        }
+    }
+
     ESP_LOGI(TAG, "Smart Sleep: Current %llu, Next %llu", current_time_ms, pm_state.next_inference_time_ms);
     ESP_LOGI(TAG, "Sleeping for remaining %lld seconds", remaining_ms / 1000);
     
@@ -167,22 +184,26 @@ bool power_manager_should_run_inference(void) {
     return is_due;
 }
 
+bool power_manager_is_sample_wake(void) {
+    return pm_state.sample_wake && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+}
+
 uint8_t power_manager_get_display_page(void) {
-    if (pm_state.current_display_page > 5) {
+    if (pm_state.current_display_page > DISPLAY_PAGE_LAST) {
         pm_state.current_display_page = 0;
     }
     return pm_state.current_display_page;
 }
 
 void power_manager_set_display_page(uint8_t page) {
-    if (page > 5) {
-        page = 5;
+    if (page > DISPLAY_PAGE_LAST) {
+        page = DISPLAY_PAGE_LAST;
     }
     pm_state.current_display_page = page;
     ESP_LOGI(TAG, "Display page set to: %d", page);
 }
 
-void power_manager_enter_deep_sleep(void) {
+static void enter_deep_sleep(bool sample_wake) {
     uint64_t sleep_duration_us = power_manager_calculate_sleep_duration();
     
     ESP_LOGI(TAG, "Entering deep sleep for %llu seconds", sleep_duration_us / 1000000);
@@ -195,12 +216,33 @@ void power_manager_enter_deep_sleep(void) {
         esp_sleep_enable_ext0_wakeup(BTN_NEXT_GPIO, 0); // Wake on LOW
     }
     
-    fflush(stdout);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
+    if (!sample_wake) {
+        fflush(stdout);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    uint32_t awake_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    if (sample_wake) {
+        pm_state.sample_wake_ms = awake_ms;
+    } else {
+        pm_state.full_wake_ms = awake_ms;
+    }
+
     esp_deep_sleep_start();
 }
 
+void power_manager_enter_deep_sleep(void) {
+    enter_deep_sleep(false);
+}
+
+void power_manager_enter_deep_sleep_fast(void) {
+    enter_deep_sleep(true);
+}
+
+uint32_t power_manager_last_wake_ms(bool sample_wake) {
+    return sample_wake ? pm_state.sample_wake_ms : pm_state.full_wake_ms;
+}
+
 void power_manager_enter_deep_sleep_now(void) {
     ESP_LOGI(TAG, "Entering immediate deep sleep (user triggered)");
     power_manager_enter_deep_sleep();
@@ -14,6 +14,14 @@
 #define INFERENCE_INTERVAL_SECONDS  60 * 60       
 #define ONE_HOUR_US                 (3600ULL * 1000000ULL) 
 
+// Between inferences, wake every SUBHOUR_SAMPLE_MINUTES to fold one reading
+// into the hourly aggregate and go straight back to sleep. 0 samples once an
+// hour only. While an anomaly alert holds, ANOMALY_ALERT_SAMPLE_MINUTES is
+// used instead.
+#ifndef SUBHOUR_SAMPLE_MINUTES
+#define SUBHOUR_SAMPLE_MINUTES      10
+#endif
+
 typedef enum {
     WAKE_CAUSE_TIMER = 0,
     WAKE_CAUSE_BUTTON,
@@ -31,6 +39,9 @@ typedef struct {
     t_bme280_s_val saved_sensor_data;    
     bool saved_wifi_connected;           
     char saved_ip_address[16];           
+    bool sample_wake;                    // Current sleep ends on a sub-hourly sample
+    uint32_t sample_wake_ms;             // App run time of the last sample wake
+    uint32_t full_wake_ms;               // ... and of the last full wake
 } power_manager_state_t;
 
 esp_err_t power_manager_init(void);
@@ -47,6 +58,9 @@ void power_manager_get_data(t_infered* prediction, t_bme280_s_val* sensor_data,
 
 bool power_manager_should_run_inference(void);
 
+// True if this is a timer wake scheduled only to take a sub-hourly sample.
+bool power_manager_is_sample_wake(void);
+
 uint8_t power_manager_get_display_page(void);
 
 void power_manager_set_display_page(uint8_t page);
@@ -55,6 +69,14 @@ void power_manager_enter_deep_sleep(void);
 
 void power_manager_enter_deep_sleep_now(void);
 
+// Sleep at the end of a sample wake: skips the settle delay, since only the
+// console can be in flight and esp_deep_sleep_start() flushes it.
+void power_manager_enter_deep_sleep_fast(void);
+
+// How long the last wake of each kind ran, in ms from app start to sleep
+// entry. The ROM and bootloader stages before app start are not included.
+uint32_t power_manager_last_wake_ms(bool sample_wake);
+
 uint64_t power_manager_get_time_ms(void);
 
 uint32_t power_manager_get_minutes_into_hour(void);
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+// Contiguous run of ring entries, oldest first.
+template <typename T>
+struct ring_span_t {
+    const T* data;
+    int size;
+};
+
+// The newest entries of a ring as at most two contiguous runs: `first` up to
+// the end of the storage, then `second` from its start. `second` is empty
+// unless the window wraps.
+template <typename T>
+struct ring_window_t {
+    ring_span_t<T> first;
+    ring_span_t<T> second;
+};
+
+// Fixed-capacity ring with no constructor, so it can be placed in
+// RTC_DATA_ATTR memory and survive deep sleep. Call clear() on a cold boot.
+template <typename T, int Capacity>
+class RingBuffer {
+public:
+    static_assert(Capacity > 0, "ring capacity must be positive");
+    static constexpr int kCapacity = Capacity;
+
+    void clear() {
+        next_ = 0;
+        count_ = 0;
+    }
+
+    void push(const T& value) {
+        data_[next_] = value;
+        next_ = next_ + 1 == Capacity ? 0 : next_ + 1;
+        if (count_ < Capacity) {
+            count_++;
+        }
+    }
+
+    int size() const { return count_; }
+
+    template <int N>
+    bool has_window() const {
+        static_assert(N > 0 && N <= Capacity, "window longer than the ring");
+        return count_ >= N;
+    }
+
+    // The newest N entries. Does not check has_window(); slots never written
+    // since clear() read as whatever the storage held.
+    template <int N>
+    ring_window_t<T> window() const {
+        static_assert(N > 0 && N <= Capacity, "window longer than the ring");
+        return latest(N);
+    }
+
+    // Runtime-length window, clamped to the capacity.
+    ring_window_t<T> latest(int n) const {
+        if (n > Capacity) {
+            n = Capacity;
+        }
+        if (n < 0) {
+            n = 0;
+        }
+        int start = next_ - n;
+        if (start < 0) {
+            start += Capacity;
+        }
+        int first = Capacity - start < n ? Capacity - start : n;
+        return { { &data_[start], first }, { data_, n - first } };
+    }
+
+private:
+    T data_[Capacity];
+    int next_;
+    int count_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "sensor_aggregate.h"
+#include "esp_attr.h"
+#include <string.h>
+
+static RTC_DATA_ATTR t_sensor_aggregate aggregate;
+
+static void welford_add(t_welford* w, uint32_t count, float x) {
+    if (count == 1) {
+        w->mean = x;
+        w->m2 = 0.0f;
+        w->min = x;
+        w->max = x;
+        return;
+    }
+    float delta = x - w->mean;
+    w->mean += delta / count;
+    w->m2 += delta * (x - w->mean);
+    if (x < w->min) {
+        w->min = x;
+    }
+    if (x > w->max) {
+        w->max = x;
+    }
+}
+
+void sensor_aggregate_reset(void) {
+    memset(&aggregate, 0, sizeof(aggregate));
+}
+
+void sensor_aggregate_add(t_packed_sample packed) {
+    t_bme280_s_val value = unpack_sample(packed);
+    aggregate.count++;
+    welford_add(&aggregate.temperature, aggregate.count, value.temperature);
+    welford_add(&aggregate.humidity, aggregate.count, value.humidity);
+    welford_add(&aggregate.pressure, aggregate.count, value.pressure);
+    aggregate.packed_sum[0] += packed.temperature;
+    aggregate.packed_sum[1] += packed.humidity;
+    aggregate.packed_sum[2] += packed.pressure;
+}
+
+// Rounds half away from zero.
+static int32_t rounded_mean(int32_t sum, uint32_t n) {
+    int32_t half = (int32_t)(n / 2);
+    return (sum >= 0 ? sum + half : sum - half) / (int32_t)n;
+}
+
+uint32_t sensor_aggregate_count(void) {
+    return aggregate.count;
+}
+
+bool sensor_aggregate_take(t_sensor_summary* summary) {
+    uint32_t n = aggregate.count;
+    if (n == 0) {
+        return false;
+    }
+
+    summary->count = n;
+    summary->mean = { aggregate.temperature.mean, aggregate.humidity.mean, aggregate.pressure.mean };
+    summary->min = { aggregate.temperature.min, aggregate.humidity.min, aggregate.pressure.min };
+    summary->max = { aggregate.temperature.max, aggregate.humidity.max, aggregate.pressure.max };
+    summary->variance = {
+        aggregate.temperature.m2 / n,
+        aggregate.humidity.m2 / n,
+        aggregate.pressure.m2 / n,
+    };
+    summary->packed_mean.temperature = (int16_t)rounded_mean(aggregate.packed_sum[0], n);
+    summary->packed_mean.humidity = (uint16_t)rounded_mean(aggregate.packed_sum[1], n);
+    summary->packed_mean.pressure = (uint16_t)rounded_mean(aggregate.packed_sum[2], n);
+
+    sensor_aggregate_reset();
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef SENSOR_AGGREGATE_H
+#define SENSOR_AGGREGATE_H
+
+#include <stdint.h>
+#include "data_structure.h"
+#include "packed_sample.h"
+
+// Running statistics of the readings taken within one hour, kept in RTC
+// memory across the sub-hourly wakes. Mean and variance use Welford's update,
+// so each reading is folded in once and never stored. The mean that goes into
+// the history is also summed in packed LSBs, so it stays in integers.
+
+typedef struct {
+    float mean;
+    float m2;                    // Sum of squared distances from the mean
+    float min;
+    float max;
+} t_welford;
+
+typedef struct {
+    uint32_t count;
+    t_welford temperature;
+    t_welford humidity;
+    t_welford pressure;
+    int32_t packed_sum[3];       // Temperature, humidity, pressure in LSBs
+} t_sensor_aggregate;
+
+// Finished hour, as pushed into the history and published on /sensor.
+typedef struct {
+    uint32_t count;
+    t_bme280_s_val mean;
+    t_bme280_s_val min;
+    t_bme280_s_val max;
+    t_bme280_s_val variance;     // Population variance, 0 for a single reading
+    t_packed_sample packed_mean; // Rounded integer mean of the packed readings
+} t_sensor_summary;
+
+// Drops the readings accumulated so far (cold boot).
+void sensor_aggregate_reset(void);
+
+void sensor_aggregate_add(t_packed_sample packed);
+
+uint32_t sensor_aggregate_count(void);
+
+// Summarises the readings since the last take and starts a new hour.
+// Returns false, leaving `summary` untouched, if there were none.
+bool sensor_aggregate_take(t_sensor_summary* summary);
+
+#endif
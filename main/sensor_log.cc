@@ -0,0 +1,422 @@
+#include "sensor_log.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include <stddef.h>
+#include <string.h>
+
+#define TAG "[SENSOR_LOG]"
+
+#define SEGMENT_SIZE            4096
+#define SEGMENT_MAGIC           0x474F4C53  // "SLOG"
+#define ERASED_WORD             0xFFFFFFFF
+#define RECORDS_PER_SEGMENT     ((SEGMENT_SIZE - sizeof(segment_header_t)) / sizeof(sensor_log_record_t))
+#define STATE_MAGIC             0x53544C47
+
+// Segment layout: header, then RECORDS_PER_SEGMENT records written in order.
+// Segments are used as a ring. In lap k, physical segment p carries sequence
+// number k * segment_count + p, and the segment after the head is always kept
+// erased so the oldest data can be dropped a whole segment at a time.
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t first_ts;
+    uint32_t reserved;
+} segment_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t head;               // Physical segment being written
+    uint32_t head_seq;
+    uint32_t head_records;
+    bool     head_open;          // Header of `head` is on flash
+    uint32_t oldest;             // Physical segment holding the oldest data
+    uint32_t segments;           // Segments with a header, head included
+    uint32_t newest_ts;
+    uint32_t pending_count;
+    bool     flush_failed;       // Retry on every append until a flush succeeds
+    sensor_log_record_t pending[SENSOR_LOG_FLUSH_EVERY];
+} log_state_t;
+
+static RTC_DATA_ATTR log_state_t log_state;
+
+static const esp_partition_t* log_partition = NULL;
+static uint32_t segment_count = 0;
+
+static uint32_t segment_addr(uint32_t segment) {
+    return segment * SEGMENT_SIZE;
+}
+
+static uint32_t record_addr(uint32_t segment, uint32_t record) {
+    return segment_addr(segment) + sizeof(segment_header_t) + record * sizeof(sensor_log_record_t);
+}
+
+static bool read_header(uint32_t segment, segment_header_t* header) {
+    if (esp_partition_read(log_partition, segment_addr(segment), header, sizeof(*header)) != ESP_OK) {
+        return false;
+    }
+    return header->magic == SEGMENT_MAGIC;
+}
+
+static esp_err_t read_records(uint32_t segment, uint32_t first, uint32_t count, sensor_log_record_t* out) {
+    return esp_partition_read(log_partition, record_addr(segment, first), out, count * sizeof(sensor_log_record_t));
+}
+
+static uint32_t read_timestamp(uint32_t segment, uint32_t record) {
+    uint32_t timestamp = ERASED_WORD;
+    esp_partition_read(log_partition, record_addr(segment, record), &timestamp, sizeof(timestamp));
+    return timestamp;
+}
+
+static esp_err_t erase_segment(uint32_t segment) {
+    return esp_partition_erase_range(log_partition, segment_addr(segment), SEGMENT_SIZE);
+}
+
+static uint8_t record_crc(const sensor_log_record_t* record) {
+    return esp_rom_crc8_le(0, (const uint8_t*)record, offsetof(sensor_log_record_t, crc));
+}
+
+static sensor_log_record_t encode_record(uint32_t timestamp, const t_bme280_s_val* value) {
+    sensor_log_record_t record;
+    record.timestamp = timestamp;
+    record.value = pack_sample(value);
+    record.reserved = 0xFF;
+    record.crc = record_crc(&record);
+    return record;
+}
+
+static void decode_record(const sensor_log_record_t* record, sensor_log_sample_t* sample) {
+    sample->timestamp = record->timestamp;
+    sample->value = unpack_sample(record->value);
+}
+
+// Records on flash in logical segment `logical` (0 = oldest).
+static uint32_t segment_records(uint32_t logical) {
+    return logical + 1 == log_state.segments ? log_state.head_records : RECORDS_PER_SEGMENT;
+}
+
+static uint32_t physical_segment(uint32_t logical) {
+    return (log_state.oldest + logical) % segment_count;
+}
+
+static esp_err_t format_log(void) {
+    ESP_LOGW(TAG, "No log found, formatting");
+    esp_err_t ret = erase_segment(0);
+    if (ret == ESP_OK) {
+        ret = erase_segment(1);
+    }
+    memset(&log_state, 0, sizeof(log_state));
+    log_state.magic = STATE_MAGIC;
+    return ret;
+}
+
+// True while `segment` belongs to the same lap as segment 0, which holds for
+// exactly [0, head] when segment 0 is valid.
+static bool in_current_lap(uint32_t segment, uint32_t seq0) {
+    segment_header_t header;
+    return read_header(segment, &header) && header.seq - seq0 == segment;
+}
+
+// Rebuilds log_state from the segment headers after RTC memory was lost.
+// Staged samples that never reached flash are gone at this point.
+static esp_err_t recover_state(void) {
+    segment_header_t header;
+    uint32_t head;
+    uint32_t head_seq;
+
+    if (read_header(0, &header)) {
+        const uint32_t seq0 = header.seq;
+        uint32_t lo = 0;
+        uint32_t hi = segment_count - 1;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi + 1) / 2;
+            if (in_current_lap(mid, seq0)) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        head = lo;
+        head_seq = seq0 + head;
+    } else if (read_header(segment_count - 1, &header)) {
+        // Segment 0 is the spare: the head is the last segment.
+        head = segment_count - 1;
+        head_seq = header.seq;
+    } else {
+        return format_log();
+    }
+
+    // Records are written in order, so the first erased slot ends the head.
+    uint32_t lo = 0;
+    uint32_t hi = RECORDS_PER_SEGMENT;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (read_timestamp(head, mid) == ERASED_WORD) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    memset(&log_state, 0, sizeof(log_state));
+    log_state.magic = STATE_MAGIC;
+    log_state.head = head;
+    log_state.head_seq = head_seq;
+    log_state.head_records = lo;
+    log_state.head_open = true;
+
+    // Finish a rotation that lost power between opening the head and erasing
+    // the next segment.
+    const uint32_t spare = (head + 1) % segment_count;
+    uint32_t spare_word = ERASED_WORD;
+    esp_partition_read(log_partition, segment_addr(spare), &spare_word, sizeof(spare_word));
+    if (spare_word != ERASED_WORD) {
+        esp_err_t ret = erase_segment(spare);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    const uint32_t after_spare = (head + 2) % segment_count;
+    if (after_spare != head && read_header(after_spare, &header)) {
+        log_state.oldest = after_spare;
+        log_state.segments = segment_count - 1;
+    } else {
+        log_state.oldest = 0;
+        log_state.segments = head + 1;
+    }
+
+    if (lo > 0) {
+        log_state.newest_ts = read_timestamp(head, lo - 1);
+    } else if (read_header(head, &header)) {
+        log_state.newest_ts = header.first_ts;
+    }
+
+    ESP_LOGI(TAG, "Recovered log: head %lu (+%lu records), %lu segments",
+             (unsigned long)head, (unsigned long)lo, (unsigned long)log_state.segments);
+    return ESP_OK;
+}
+
+esp_err_t sensor_log_init(bool warm_start) {
+    log_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                             SENSOR_LOG_PARTITION_LABEL);
+    if (log_partition == NULL) {
+        ESP_LOGE(TAG, "Partition '%s' not found", SENSOR_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    segment_count = log_partition->size / SEGMENT_SIZE;
+    if (segment_count < 3) {
+        ESP_LOGE(TAG, "Partition too small for a log");
+        log_partition = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (warm_start && log_state.magic == STATE_MAGIC) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = recover_state();
+    if (ret != ESP_OK) {
+        log_partition = NULL;
+    }
+    return ret;
+}
+
+// Opens the spare as the new head and erases the segment after it, dropping
+// the oldest data once the ring is full.
+static esp_err_t open_segment(uint32_t first_ts) {
+    if (log_state.head_open) {
+        log_state.head = (log_state.head + 1) % segment_count;
+        log_state.head_seq++;
+        log_state.head_records = 0;
+        log_state.head_open = false;
+    }
+
+    segment_header_t header = {
+        .magic = SEGMENT_MAGIC,
+        .seq = log_state.head_seq,
+        .first_ts = first_ts,
+        .reserved = ERASED_WORD,
+    };
+    esp_err_t ret = esp_partition_write(log_partition, segment_addr(log_state.head), &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    log_state.head_open = true;
+    log_state.segments++;
+
+    if (log_state.segments == segment_count) {
+        log_state.segments--;
+        log_state.oldest = (log_state.oldest + 1) % segment_count;
+    }
+    return erase_segment((log_state.head + 1) % segment_count);
+}
+
+// Drops the `count` oldest staged records.
+static void unstage(uint32_t count) {
+    log_state.pending_count -= count;
+    memmove(&log_state.pending[0], &log_state.pending[count],
+            log_state.pending_count * sizeof(sensor_log_record_t));
+}
+
+// Writes the staged records to flash. Each run leaves the stage as soon as
+// it is written, so a failure part way keeps only what is not on flash yet.
+static esp_err_t write_pending(void) {
+    while (log_state.pending_count > 0) {
+        if (!log_state.head_open || log_state.head_records == RECORDS_PER_SEGMENT) {
+            esp_err_t ret = open_segment(log_state.pending[0].timestamp);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to open segment: %s", esp_err_to_name(ret));
+                return ret;
+            }
+        }
+
+        uint32_t run = log_state.pending_count;
+        if (run > RECORDS_PER_SEGMENT - log_state.head_records) {
+            run = RECORDS_PER_SEGMENT - log_state.head_records;
+        }
+        esp_err_t ret = esp_partition_write(log_partition, record_addr(log_state.head, log_state.head_records),
+                                            &log_state.pending[0], run * sizeof(sensor_log_record_t));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write records: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        log_state.head_records += run;
+        unstage(run);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t flush_pending(void) {
+    esp_err_t ret = write_pending();
+    log_state.flush_failed = ret != ESP_OK;
+    return ret;
+}
+
+esp_err_t sensor_log_append(uint32_t timestamp, const t_bme280_s_val* value) {
+    if (log_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (timestamp < log_state.newest_ts) {
+        timestamp = log_state.newest_ts;
+    }
+
+    // The stage is only full here if flushing it failed. If it fails again,
+    // the oldest staged sample makes room for the new one.
+    if (log_state.pending_count == SENSOR_LOG_FLUSH_EVERY && flush_pending() != ESP_OK) {
+        ESP_LOGW(TAG, "Log not writable, dropping the oldest staged sample");
+        unstage(1);
+    }
+
+    log_state.pending[log_state.pending_count++] = encode_record(timestamp, value);
+    log_state.newest_ts = timestamp;
+
+    if (log_state.flush_failed || log_state.pending_count == SENSOR_LOG_FLUSH_EVERY) {
+        return flush_pending();
+    }
+    return ESP_OK;
+}
+
+esp_err_t sensor_log_seek(sensor_log_cursor_t* cursor, uint32_t from_ts, uint32_t to_ts) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->start_ts = from_ts;
+    cursor->end_ts = to_ts;
+    if (log_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (log_state.segments == 0) {
+        return ESP_OK;
+    }
+
+    // Last segment starting at or before from_ts.
+    uint32_t lo = 0;
+    uint32_t hi = log_state.segments - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        segment_header_t header;
+        if (!read_header(physical_segment(mid), &header)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (header.first_ts <= from_ts) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    // First record in it at or after from_ts.
+    const uint32_t segment = physical_segment(lo);
+    uint32_t first = 0;
+    uint32_t last = segment_records(lo);
+    while (first < last) {
+        uint32_t mid = (first + last) / 2;
+        if (read_timestamp(segment, mid) < from_ts) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+
+    cursor->segment = lo;
+    cursor->record = first;
+    cursor->in_flash = true;
+    return ESP_OK;
+}
+
+static bool next_record(sensor_log_cursor_t* cursor, sensor_log_record_t* record) {
+    while (cursor->in_flash) {
+        if (cursor->chunk_pos < cursor->chunk_len) {
+            *record = cursor->chunk[cursor->chunk_pos++];
+            return true;
+        }
+        if (cursor->segment >= log_state.segments) {
+            cursor->in_flash = false;
+            break;
+        }
+        uint32_t available = segment_records(cursor->segment) - cursor->record;
+        if (available == 0) {
+            cursor->segment++;
+            cursor->record = 0;
+            continue;
+        }
+        if (available > SENSOR_LOG_CURSOR_CHUNK) {
+            available = SENSOR_LOG_CURSOR_CHUNK;
+        }
+        if (read_records(physical_segment(cursor->segment), cursor->record, available, cursor->chunk) != ESP_OK) {
+            cursor->in_flash = false;
+            break;
+        }
+        cursor->record += available;
+        cursor->chunk_len = available;
+        cursor->chunk_pos = 0;
+    }
+
+    if (cursor->pending < log_state.pending_count) {
+        *record = log_state.pending[cursor->pending++];
+        return true;
+    }
+    return false;
+}
+
+bool sensor_log_next(sensor_log_cursor_t* cursor, sensor_log_sample_t* sample) {
+    sensor_log_record_t record;
+    while (next_record(cursor, &record)) {
+        if (record.crc != record_crc(&record) || record.timestamp < cursor->start_ts) {
+            continue;
+        }
+        if (record.timestamp > cursor->end_ts) {
+            cursor->in_flash = false;
+            cursor->pending = log_state.pending_count;
+            return false;
+        }
+        decode_record(&record, sample);
+        return true;
+    }
+    return false;
+}
+
+uint32_t sensor_log_newest_timestamp(void) {
+    return log_state.newest_ts;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef SENSOR_LOG_H
+#define SENSOR_LOG_H
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_structure.h"
+#include "packed_sample.h"
+
+// Flash tier of the sensor history. Samples are appended to the "spiffs"
+// partition, which is used raw (no filesystem) as a ring of 4 KB segments.
+// Each segment starts with a header carrying a sequence number and the
+// timestamp of its first record; those headers are the block index used for
+// binary-searching a time range.
+//
+// Appends are staged in RTC memory and written in batches of
+// SENSOR_LOG_FLUSH_EVERY, so most wakes don't touch flash at all. RTC memory
+// only survives deep sleep: any other reset (power loss, brownout, panic,
+// watchdog) drops the up to SENSOR_LOG_FLUSH_EVERY - 1 staged samples. The
+// app never restarts on purpose, so there is no flush ahead of a restart.
+
+#define SENSOR_LOG_PARTITION_LABEL  "spiffs"
+#define SENSOR_LOG_FLUSH_EVERY      6
+#define SENSOR_LOG_CURSOR_CHUNK     16
+
+typedef struct {
+    uint32_t timestamp;          // Seconds, from gettimeofday()
+    t_bme280_s_val value;
+} sensor_log_sample_t;
+
+// On-flash record, 12 bytes.
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;
+    t_packed_sample value;
+    uint8_t  reserved;
+    uint8_t  crc;
+} sensor_log_record_t;
+
+// Streams the samples of a time range in chunks, so long windows can be
+// walked without holding them in RAM. Fill with sensor_log_seek().
+typedef struct {
+    uint32_t start_ts;
+    uint32_t end_ts;
+    uint32_t segment;            // Logical segment, 0 = oldest
+    uint32_t record;             // Next record within the segment
+    uint32_t pending;            // Next staged RTC record, once flash is done
+    bool     in_flash;
+    uint8_t  chunk_len;
+    uint8_t  chunk_pos;
+    sensor_log_record_t chunk[SENSOR_LOG_CURSOR_CHUNK];
+} sensor_log_cursor_t;
+
+// Mounts the log. After a deep sleep wake the write position comes from RTC
+// memory; otherwise it is recovered from flash with a binary search.
+esp_err_t sensor_log_init(bool warm_start);
+
+// Stages one sample and writes the batch to flash once it is full.
+// Timestamps older than the newest logged one are clamped to keep the log
+// sorted. After a failed write every append retries it; while flash keeps
+// failing, the oldest staged sample is dropped to make room.
+esp_err_t sensor_log_append(uint32_t timestamp, const t_bme280_s_val* value);
+
+// Positions `cursor` at the first sample with from_ts <= timestamp <= to_ts.
+esp_err_t sensor_log_seek(sensor_log_cursor_t* cursor, uint32_t from_ts, uint32_t to_ts);
+
+// Returns the next sample in range, false once the range is exhausted.
+bool sensor_log_next(sensor_log_cursor_t* cursor, sensor_log_sample_t* sample);
+
+// Timestamp of the newest sample (flash or staged), 0 if the log is empty.
+uint32_t sensor_log_newest_timestamp(void);
+
+#endif
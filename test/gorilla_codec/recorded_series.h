@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef RECORDED_SERIES_H
+#define RECORDED_SERIES_H
+
+#include <stdint.h>
+#include "packed_sample.h"
+
+// Three days of hourly records as the flash log stores them (timestamp, then
+// temperature, humidity and pressure in packed LSBs). Wake-up jitter of a
+// few seconds, and hour 41 is missing.
+typedef struct {
+    uint32_t timestamp;
+    t_packed_sample value;
+} t_recorded_sample;
+
+static const t_recorded_sample recorded_series[] = {
+    { 1760399999u, { 1893, 6223, 35651 } },
+    { 1760403597u, { 1828, 6370, 35647 } },
+    { 1760407201u, { 1784, 6486, 35640 } },
+    { 1760410801u, { 1774, 6433, 35640 } },
+    { 1760414397u, { 1799, 6451, 35636 } },
+    { 1760418001u, { 1819, 6292, 35641 } },
+    { 1760421597u, { 1875, 6229, 35635 } },
+    { 1760425201u, { 1967, 6024, 35642 } },
+    { 1760428798u, { 2064, 5864, 35643 } },
+    { 1760432402u, { 2155, 5613, 35645 } },
+    { 1760435998u, { 2234, 5368, 35648 } },
+    { 1760439600u, { 2327, 5130, 35653 } },
+    { 1760443198u, { 2416, 4935, 35653 } },
+    { 1760446799u, { 2472, 4816, 35654 } },
+    { 1760450397u, { 2526, 4759, 35659 } },
+    { 1760454000u, { 2523, 4610, 35670 } },
+    { 1760457597u, { 2518, 4679, 35679 } },
+    { 1760461202u, { 2472, 4793, 35691 } },
+    { 1760464803u, { 2397, 4984, 35703 } },
+    { 1760468402u, { 2335, 5210, 35714 } },
+    { 1760471999u, { 2226, 5266, 35725 } },
+    { 1760475600u, { 2141, 5628, 35733 } },
+    { 1760479200u, { 2042, 5876, 35741 } },
+    { 1760482799u, { 1960, 6071, 35754 } },
+    { 1760486400u, { 1893, 6213, 35768 } },
+    { 1760489999u, { 1831, 6434, 35776 } },
+    { 1760493603u, { 1765, 6450, 35795 } },
+    { 1760497200u, { 1768, 6522, 35808 } },
+    { 1760500798u, { 1793, 6517, 35830 } },
+    { 1760504398u, { 1823, 6379, 35845 } },
+    { 1760508000u, { 1865, 6225, 35859 } },
+    { 1760511603u, { 1966, 5995, 35874 } },
+    { 1760515202u, { 2051, 5789, 35896 } },
+    { 1760518802u, { 2129, 5612, 35909 } },
+    { 1760522400u, { 2238, 5395, 35923 } },
+    { 1760525998u, { 2345, 5132, 35941 } },
+    { 1760529601u, { 2419, 4964, 35959 } },
+    { 1760533199u, { 2484, 4809, 35976 } },
+    { 1760536798u, { 2512, 4716, 35994 } },
+    { 1760540399u, { 2541, 4680, 36012 } },
+    { 1760544000u, { 2530, 4729, 36029 } },
+    { 1760551197u, { 2419, 4963, 36041 } },
+    { 1760554800u, { 2343, 5129, 36069 } },
+    { 1760558401u, { 2253, 5328, 36093 } },
+    { 1760561997u, { 2151, 5566, 36111 } },
+    { 1760565603u, { 2048, 5830, 36134 } },
+    { 1760569198u, { 1955, 6072, 36148 } },
+    { 1760572802u, { 1878, 6249, 36174 } },
+    { 1760576403u, { 1834, 6322, 36196 } },
+    { 1760579998u, { 1765, 6484, 36219 } },
+    { 1760583602u, { 1773, 6502, 36237 } },
+    { 1760587202u, { 1792, 6440, 36254 } },
+    { 1760590803u, { 1854, 6334, 36276 } },
+    { 1760594398u, { 1878, 6273, 36297 } },
+    { 1760597999u, { 1965, 6104, 36321 } },
+    { 1760601600u, { 2038, 5864, 36337 } },
+    { 1760605202u, { 2165, 5630, 36361 } },
+    { 1760608803u, { 2237, 5393, 36386 } },
+    { 1760612400u, { 2343, 5115, 36407 } },
+    { 1760616000u, { 2388, 4899, 36425 } },
+    { 1760619597u, { 2478, 4796, 36443 } },
+    { 1760623200u, { 2522, 4738, 36457 } },
+    { 1760626803u, { 2519, 4674, 36474 } },
+    { 1760630401u, { 2514, 4735, 36490 } },
+    { 1760634002u, { 2470, 4781, 36509 } },
+    { 1760637603u, { 2414, 4991, 36531 } },
+    { 1760641197u, { 2340, 5183, 36545 } },
+    { 1760644799u, { 2264, 5294, 36556 } },
+    { 1760648397u, { 2159, 5580, 36563 } },
+    { 1760652001u, { 2056, 5754, 36580 } },
+    { 1760655601u, { 1965, 6067, 36583 } },
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include "gorilla_codec.h"
+#include "packed_sample.h"
+#include "recorded_series.h"
+
+#define SERIES_LEN      (sizeof(recorded_series) / sizeof(recorded_series[0]))
+// What one sample costs without the codec: the flash record, and the
+// timestamp plus three floats that sensor_log_next() hands out.
+#define RECORD_BYTES    (sizeof(uint32_t) + sizeof(t_packed_sample))
+#define FLOAT_BYTES     (sizeof(uint32_t) + sizeof(t_bme280_s_val))
+
+static uint8_t stream[SERIES_LEN * ((GORILLA_MAX_SAMPLE_BITS + 7) / 8)];
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                   \
+        if (!(cond)) {                          \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                \
+            printf("\n");                       \
+            failures++;                         \
+        }                                       \
+    } while (0)
+
+// Encodes the first `n` samples and checks they decode to the same bits.
+// Returns the encoded size in bytes.
+static size_t round_trip(size_t n) {
+    gorilla_encoder_t enc;
+    gorilla_encoder_init(&enc, stream, sizeof(stream));
+    for (size_t i = 0; i < n; i++) {
+        t_bme280_s_val value = unpack_sample(recorded_series[i].value);
+        CHECK(gorilla_encode(&enc, recorded_series[i].timestamp, &value),
+              "encode of sample %zu ran out of space", i);
+    }
+    CHECK(enc.count == n, "encoder counted %u of %zu", (unsigned)enc.count, n);
+    size_t size = gorilla_encoded_size(&enc);
+
+    gorilla_decoder_t dec;
+    gorilla_decoder_init(&dec, stream, size, enc.count);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t timestamp;
+        t_bme280_s_val value;
+        if (!gorilla_decode(&dec, &timestamp, &value)) {
+            CHECK(false, "stream of %zu samples ended at %zu", n, i);
+            break;
+        }
+        t_bme280_s_val expected = unpack_sample(recorded_series[i].value);
+        CHECK(timestamp == recorded_series[i].timestamp,
+              "sample %zu timestamp %u, expected %u", i, (unsigned)timestamp,
+              (unsigned)recorded_series[i].timestamp);
+        CHECK(memcmp(&value, &expected, sizeof(value)) == 0,
+              "sample %zu value differs", i);
+    }
+    uint32_t timestamp;
+    t_bme280_s_val value;
+    CHECK(!gorilla_decode(&dec, &timestamp, &value), "decoded past count %zu", n);
+    return size;
+}
+
+// The encoder must refuse a sample it might not fit, and leave what it has
+// decodable.
+static void check_full_buffer(void) {
+    uint8_t small[4 * ((GORILLA_MAX_SAMPLE_BITS + 7) / 8)];
+    gorilla_encoder_t enc;
+    gorilla_encoder_init(&enc, small, sizeof(small));
+    size_t accepted = 0;
+    for (size_t i = 0; i < SERIES_LEN; i++) {
+        t_bme280_s_val value = unpack_sample(recorded_series[i].value);
+        if (!gorilla_encode(&enc, recorded_series[i].timestamp, &value)) {
+            break;
+        }
+        accepted++;
+    }
+    CHECK(accepted >= 4 && accepted < SERIES_LEN, "small buffer took %zu samples", accepted);
+
+    gorilla_decoder_t dec;
+    gorilla_decoder_init(&dec, small, gorilla_encoded_size(&enc), enc.count);
+    size_t decoded = 0;
+    uint32_t timestamp;
+    t_bme280_s_val value;
+    while (gorilla_decode(&dec, &timestamp, &value)) {
+        decoded++;
+    }
+    CHECK(decoded == accepted, "decoded %zu of %zu accepted samples", decoded, accepted);
+}
+
+int main(void) {
+    CHECK(round_trip(0) == 0, "empty stream is not empty");
+    round_trip(1);
+
+    size_t size = round_trip(SERIES_LEN);
+    check_full_buffer();
+
+    double per_sample = (double)size / SERIES_LEN;
+    printf("%zu samples in %zu bytes: %.2f bytes/sample\n", SERIES_LEN, size, per_sample);
+    printf("  vs %zu bytes/record in flash (%.1fx), %zu bytes as floats (%.1fx)\n",
+           RECORD_BYTES, RECORD_BYTES / per_sample, FLOAT_BYTES, FLOAT_BYTES / per_sample);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}